@@ -0,0 +1,214 @@
+#include "Animation.h"
+#include "Utils.h"
+#include "DebugLevel.h"
+
+#define CLASS_NAME "Animation"
+
+//=============================================================================
+Animation::Animation(uint8_t u8NewDebugLevel) {
+    u8DebugLevel = u8NewDebugLevel;
+}
+
+//=============================================================================
+// Only the header is read here, the frames are streamed by vLoop().
+bool Animation::boOpen() {
+    vClose();
+    if (boUploading) return false;
+
+    file = SPIFFS.open(AnimationFileName, "r");
+    if (!file) return false;
+    if (   (file.read((uint8_t *)&stHeader, sizeof(tAnimationHeader)) != sizeof(tAnimationHeader))
+        || memcmp(stHeader.acMagic, "WLA1", 4)
+        || !stHeader.u16LedCount || (stHeader.u16LedCount > AnimationLedCountMax)) {
+        vConsole(u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, " invalid animation file");
+        vClose();
+        return false;
+    }
+
+    size_t sizeFrames = (size_t)stHeader.u16LedCount * 3 * 2;
+    if (ESP.getFreeHeap() < (sizeFrames + AnimationHeapReserve)) {
+        vConsole(u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, " frame buffers don't fit into the heap");
+        vClose();
+        return false;
+    }
+    pu8Frames = (uint8_t *)calloc(sizeFrames, 1);
+    if (!pu8Frames) {
+        vClose();
+        return false;
+    }
+    pu8Shown     = pu8Frames;
+    pu8Next      = pu8Frames + sizeFrames / 2;
+    u16ReadLen   = 0;
+    u16ReadPos   = 0;
+    enState      = nAnimationFrameHeader;
+    u8OpLen      = 0;
+    boNextReady  = false;
+    u32FrameTime = 0;
+    if (u8DebugLevel & DEBUG_LED_EVENTS) {
+        char buffer[100];
+        sprintf(buffer, " Leds:%d Frames:%d Period:%dms Size:%lu",
+            stHeader.u16LedCount, stHeader.u16FrameCount, stHeader.u16FramePeriod, (unsigned long)file.size());
+        vConsole(u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+    }
+    return true;
+}
+
+//=============================================================================
+void Animation::vClose() {
+    if (file) file.close();
+    free(pu8Frames);
+    pu8Frames   = NULL;
+    pu8Shown    = NULL;
+    pu8Next     = NULL;
+    boNextReady = false;
+}
+
+//=============================================================================
+bool Animation::boIsOpen() {
+    return pu8Frames != NULL;
+}
+
+//=============================================================================
+void Animation::vSetUploading(bool boNewUploading) {
+    if (boNewUploading) {
+        boReopen = boReopen || boIsOpen(); // continue with the new file
+    }
+    boUploading = boNewUploading;
+}
+
+//=============================================================================
+void Animation::vReopen() {
+    boReopen = true;
+}
+
+//=============================================================================
+// At most one chunk is read per call, the rest of the loop isn't delayed by
+// the flash. Decoding stops at the end of a frame, until it was shown.
+void Animation::vLoop() {
+    if (boUploading) {
+        if (boIsOpen()) vClose();
+        return;
+    }
+    if (boReopen) {
+        boReopen = false;
+        boOpen();
+    }
+    if (!boIsOpen() || boNextReady) return;
+
+    if (u16ReadPos >= u16ReadLen) {
+        if (!file.available()) {
+            // loop: continue with the first (key) frame
+            file.seek(sizeof(tAnimationHeader), SeekSet);
+        }
+        u16ReadLen = (uint16_t)file.read(au8ReadBuf, AnimationReadChunk);
+        u16ReadPos = 0;
+        if (!u16ReadLen) return;
+    }
+    while ((u16ReadPos < u16ReadLen) && !boNextReady && boIsOpen()) {
+        vDecode(au8ReadBuf[u16ReadPos++]);
+    }
+}
+
+//=============================================================================
+// byte wise decoder, so a frame may be spread over any number of chunks
+void Animation::vDecode(uint8_t u8Byte) {
+    uint8_t *pu8Pixel;
+
+    if (enState != nAnimationFrameHeader) u16FrameLeft--;
+
+    switch (enState) {
+        case nAnimationFrameHeader:
+            au8Op[u8OpLen++] = u8Byte;
+            if (u8OpLen < 3) return;
+            u8OpLen      = 0;
+            u16FrameLeft = au8Op[1] | ((uint16_t)au8Op[2] << 8);
+            if ((au8Op[0] != 'K') && (au8Op[0] != 'D')) {
+                vConsole(u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, " invalid frame type");
+                vClose();
+                return;
+            }
+            // unchanged LEDs keep the color of the shown frame
+            memcpy(pu8Next, pu8Shown, (size_t)stHeader.u16LedCount * 3);
+            u16Pixel = 0;
+            enState  = (au8Op[0] == 'K') ? nAnimationKeyRun : nAnimationDeltaSpan;
+            if (!u16FrameLeft) vFrameDone();
+            return;
+
+        case nAnimationKeyRun:
+            au8Op[u8OpLen++] = u8Byte;
+            if (u8OpLen == 4) {
+                u8OpLen = 0;
+                for (uint16_t u16Count = (uint16_t)au8Op[0] + 1; u16Count && (u16Pixel < stHeader.u16LedCount); u16Count--) {
+                    pu8Pixel    = pu8Next + (size_t)u16Pixel++ * 3;
+                    pu8Pixel[0] = au8Op[1];
+                    pu8Pixel[1] = au8Op[2];
+                    pu8Pixel[2] = au8Op[3];
+                }
+            }
+            break;
+
+        case nAnimationDeltaSpan:
+            au8Op[u8OpLen++] = u8Byte;
+            if (u8OpLen == 3) {
+                u8OpLen     = 0;
+                u16Pixel    = au8Op[0] | ((uint16_t)au8Op[1] << 8);
+                u16SpanLeft = (uint16_t)au8Op[2] + 1;
+                u8ColorIdx  = 0;
+                enState     = nAnimationDeltaPixels;
+            }
+            break;
+
+        case nAnimationDeltaPixels:
+            if (u16Pixel < stHeader.u16LedCount) pu8Next[(size_t)u16Pixel * 3 + u8ColorIdx] = u8Byte;
+            if (++u8ColorIdx == 3) {
+                u8ColorIdx = 0;
+                u16Pixel++;
+                if (!--u16SpanLeft) enState = nAnimationDeltaSpan;
+            }
+            break;
+    }
+    if (!u16FrameLeft) vFrameDone();
+}
+
+//=============================================================================
+void Animation::vFrameDone() {
+    boNextReady = true;
+    enState     = nAnimationFrameHeader;
+    u8OpLen     = 0;
+}
+
+//=============================================================================
+// Advance the animation by its own frame period. Several render calls in the
+// same millisecond (segments) advance it only once.
+const uint8_t *Animation::pu8GetFrame(unsigned long ulMillis, uint16_t u16DeltaMs) {
+    if (!boIsOpen()) return NULL;
+
+    if (ulMillis != ulLastMillis) {
+        ulLastMillis  = ulMillis;
+        u32FrameTime += u16DeltaMs;
+        if (u32FrameTime >= stHeader.u16FramePeriod) {
+            if (boNextReady) {
+                uint8_t *pu8Swap = pu8Shown;
+                pu8Shown         = pu8Next;
+                pu8Next          = pu8Swap;
+                boNextReady      = false;
+                u32FrameTime    -= stHeader.u16FramePeriod;
+                if (u32FrameTime > stHeader.u16FramePeriod) u32FrameTime = stHeader.u16FramePeriod; // don't catch up after a stall
+            } else {
+                u32Underruns++; // the next frame is shown as soon as it's decoded
+                u32FrameTime = stHeader.u16FramePeriod;
+            }
+        }
+    }
+    return pu8Shown;
+}
+
+//=============================================================================
+uint16_t Animation::u16GetLedCount() {
+    return boIsOpen() ? stHeader.u16LedCount : 0;
+}
+
+//=============================================================================
+uint32_t Animation::u32GetUnderruns() {
+    return u32Underruns;
+}
@@ -0,0 +1,77 @@
+#ifndef Animation_h
+#define Animation_h
+#include <Arduino.h>
+#include <FS.h>
+
+#define AnimationFileName    "/animation.wla" // uploaded animation in the SPIFFS
+#define AnimationLedCountMax 1000   // max. LEDs of an animation
+#define AnimationReadChunk   128    // read-ahead per loop call [byte], bounds the time of one flash read
+#define AnimationHeapReserve 12288  // free heap kept for WiFi, web server and MQTT [byte]
+
+// Animation file, all values little endian:
+//   header:  "WLA1", u16 LedCount, u16 FrameCount, u16 FramePeriod [ms], u16 reserved
+//   frames:  u8 type, u16 payload length, payload
+//     'K' key frame:   runs of [u8 count-1, R, G, B] from LED 0
+//     'D' delta frame: spans of [u16 first LED, u8 count-1, count * (R, G, B)],
+//                      all other LEDs keep the color of the previous frame
+// The first frame must be a key frame, the playback loops at the end of the file.
+struct tAnimationHeader {
+    char     acMagic[4];
+    uint16_t u16LedCount;
+    uint16_t u16FrameCount;
+    uint16_t u16FramePeriod;
+    uint16_t u16Reserved;
+} __attribute__((packed));
+
+enum tAnimationState {
+    nAnimationFrameHeader = 0,
+    nAnimationKeyRun,
+    nAnimationDeltaSpan,
+    nAnimationDeltaPixels
+};
+
+// Streams the animation from the flash: vLoop() reads one small chunk per call
+// and decodes it into the next frame, the render call only swaps the frame
+// buffers, when the next frame is complete. A slow flash delays the animation,
+// but never the frame scheduler.
+class Animation {
+    public:
+        Animation(uint8_t);
+        bool boOpen();                  // open the file and allocate the frame buffers, false: no valid animation
+        void vClose();                  // close the file and free the frame buffers
+        bool boIsOpen();
+        void vSetUploading(bool);       // a new file is written, the playback is stopped until it's complete
+        void vReopen();                 // open the file again with the next vLoop(), e.g. after an upload
+        void vLoop();                   // read ahead and decode, call as often as possible
+        const uint8_t *pu8GetFrame(unsigned long, uint16_t); // millis(), animation time [ms] -> RGB per LED, NULL: none
+        uint16_t u16GetLedCount();      // LEDs of the animation
+        uint32_t u32GetUnderruns();     // frames, which were not decoded in time
+
+    private:
+        void vDecode(uint8_t);
+        void vFrameDone();
+        uint8_t  u8DebugLevel        = 0;
+        File     file;
+        tAnimationHeader stHeader;
+        uint8_t  *pu8Frames          = NULL; // both frame buffers (2 * LedCount * 3)
+        uint8_t  *pu8Shown           = NULL; // frame of the render calls
+        uint8_t  *pu8Next            = NULL; // frame under construction
+        uint8_t  au8ReadBuf[AnimationReadChunk];
+        uint16_t u16ReadLen          = 0;
+        uint16_t u16ReadPos          = 0;
+        tAnimationState enState      = nAnimationFrameHeader;
+        uint8_t  au8Op[4];                   // collected header bytes of a frame, run or span
+        uint8_t  u8OpLen             = 0;
+        uint16_t u16FrameLeft        = 0;    // payload bytes of the current frame
+        uint16_t u16Pixel            = 0;    // next LED of the run or span
+        uint16_t u16SpanLeft         = 0;    // LEDs of the span
+        uint8_t  u8ColorIdx          = 0;    // next color byte of the span pixel
+        bool     boNextReady         = false;
+        volatile bool boUploading    = false;
+        volatile bool boReopen       = false;
+        unsigned long ulLastMillis   = 0;
+        uint32_t u32FrameTime        = 0;    // animation time since the last frame [ms]
+        uint32_t u32Underruns        = 0;
+};
+
+#endif
@@ -10,6 +10,7 @@
 #define ADC_INTERVAL 10           // start ADC every x ms (WIFI and Webserver are unstable when ADC converts very often!?)
 #define Button_ShortPress     30  // Button pressed longer than x ms but shorter than Button_LongPress
 #define Button_LongPress      500 // Button pressed longer than x ms
+#define Button_DimTau         300 // time constant of the brightness damping by the distance [ms]
 
 //=============================================================================
 Buttons::Buttons(uint8_t u8NewDebugLevel) {
@@ -121,7 +122,7 @@ void Buttons::vLoop() {
     static bool boTmpStripeOn        = false;
     static bool boStripeOn           = false;
     static bool boDarken             = true; // true:u8BrightnessDay/Night-- / false: u8BrightnessDay/Night++
-    static PT1 *cDimDamp             = new PT1(10, 300);
+    static PT1 *cDimDamp             = new PT1(Button_DimTau);
 
     if (pEep->u8MotionSensorEnabled) {
         vReadMotionSensor();
@@ -194,7 +195,7 @@ void Buttons::vLoop() {
                 case nByDistance:
                     // change brightness via distance
                     if (pNtpTime->stLocal.boSunHasRisen) {
-                        pEep->u8BrightnessDay = (uint8_t)cDimDamp->fGetDampedVal(
+                        pEep->u8BrightnessDay = (uint8_t)cDimDamp->i16GetDampedVal(
                             map(
                                 u16IrDistance,
                                 pEep->u16CalibrationValue,
@@ -202,7 +203,7 @@ void Buttons::vLoop() {
                                 pEep->u8BrightnessMin,
                                 pEep->u8BrightnessMax));
                     } else {
-                        pEep->u8BrightnessNight = (uint8_t)cDimDamp->fGetDampedVal(
+                        pEep->u8BrightnessNight = (uint8_t)cDimDamp->i16GetDampedVal(
                             map(
                                 u16IrDistance,
                                 pEep->u16CalibrationValue,
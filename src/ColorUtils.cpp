@@ -0,0 +1,52 @@
+#include "ColorUtils.h"
+
+#ifdef COLOR_HSB_FLOAT
+bool boHsbFloat = false;
+#endif
+
+//=======================================================================
+// exact floor(x / 255) for 0 <= x <= 255 * 255 without a division
+static inline uint32_t u32Div255(uint32_t u32Val) {
+    return (u32Val + 1 + (u32Val >> 8)) >> 8;
+}
+
+//=======================================================================
+// Fixed-point HSB to RGB conversion, same sector math as
+// RgbColorBase::_HsbToRgb() (NeoPixelBus), but without any float operation.
+// The result differs at most +/-1 LSB from RgbColor(HsbColor(...)).
+RgbColor rgbHsbToRgb(
+    uint16_t u16Hue,
+    uint8_t u8Saturation,
+    uint8_t u8Brightness)
+{
+#ifdef COLOR_HSB_FLOAT
+    if (boHsbFloat) {
+        return RgbColor(HsbColor(u16Hue / (float)0xffff, u8Saturation / (float)0xff, u8Brightness / (float)0xff)); // see: https://github.com/Makuna/NeoPixelBus/wiki/HsbColor-object-API
+    }
+#endif
+    if (!u8Saturation) {
+        return RgbColor(u8Brightness); // achromatic or black
+    }
+
+    // hue * 6 / 0xffff as 16.16 fixed point value (0xffff is 6.0 like the float path)
+    uint32_t u32Hue6 = (uint32_t)u16Hue * 6;
+    u32Hue6 += u32Hue6 >> 16;
+    uint8_t  u8Sector   = (uint8_t)(u32Hue6 >> 16);     // 0..6
+    uint32_t u32Fract   = u32Hue6 & 0xffff;             // 0..0xffff (1.0 = 0x10000)
+    if (u8Sector >= 6) u8Sector = 0;                    // 360° is 0°
+
+    // v * (1 - s * f) scaled to 0..255, floor(Bri * (255 * 2^16 - Sat * f) / (255 * 2^16))
+    uint32_t u32SatMax = (uint32_t)255 << 16;
+    uint8_t u8P = (uint8_t)u32Div255((uint32_t)u8Brightness * (255 - u8Saturation));
+    uint8_t u8Q = (uint8_t)u32Div255(((uint32_t)u8Brightness * (u32SatMax - u8Saturation * u32Fract)) >> 16);
+    uint8_t u8T = (uint8_t)u32Div255(((uint32_t)u8Brightness * (u32SatMax - u8Saturation * (0x10000 - u32Fract))) >> 16);
+
+    switch (u8Sector) {
+        case 0:  return RgbColor(u8Brightness, u8T, u8P);
+        case 1:  return RgbColor(u8Q, u8Brightness, u8P);
+        case 2:  return RgbColor(u8P, u8Brightness, u8T);
+        case 3:  return RgbColor(u8P, u8Q, u8Brightness);
+        case 4:  return RgbColor(u8T, u8P, u8Brightness);
+        default: return RgbColor(u8Brightness, u8P, u8Q);
+    }
+}
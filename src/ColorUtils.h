@@ -0,0 +1,16 @@
+#ifndef ColorUtils_h
+#define ColorUtils_h
+#include <Arduino.h>
+#include <NeoPixelBus.h> // see: https://github.com/Makuna/NeoPixelBus
+
+// integer version of RgbColor(HsbColor(H, S, B)), the ESP8266 has no FPU
+// hue: 0..0xffff (full circle), saturation: 0..0xff, brightness: 0..0xff
+RgbColor rgbHsbToRgb(uint16_t, uint8_t, uint8_t);
+
+#ifdef COLOR_HSB_FLOAT
+// host benchmark (build flag -D COLOR_HSB_FLOAT): true, rgbHsbToRgb() converts
+// with RgbColor(HsbColor(...)) like before the fixed-point kernel
+extern bool boHsbFloat;
+#endif
+
+#endif
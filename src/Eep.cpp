@@ -6,531 +6,419 @@
 
 #define CLASS_NAME       "Eep"
 
-#define EepAdr_ChipId                0
-#define EepAdr_u16LedCount           (EepAdr_ChipId + sizeof(ESP.getChipId()))
-#define EepAdr_u16CalibrationValue   (EepAdr_u16LedCount + sizeof(uint16_t))
-#define EepAdr_u16Hue                (EepAdr_u16CalibrationValue + sizeof(uint16_t))
-#define EepAdr_u8Saturation          (EepAdr_u16Hue + sizeof(uint16_t))
-#define EepAdr_u8BrightnessDay       (EepAdr_u8Saturation + sizeof(uint8_t))
-#define EepAdr_u8DimMode             (EepAdr_u8BrightnessDay + sizeof(uint8_t))
-#define EepAdr_acWifiSsid            (EepAdr_u8DimMode + sizeof(uint8_t))
-#define EepAdr_acWifiPwd             (EepAdr_acWifiSsid + EepStringSize)
-#define EepAdr_u8WiFiApMode          (EepAdr_acWifiPwd + EepStringSize)
-#define EepAdr_u8BrightnessMin       (EepAdr_u8WiFiApMode + sizeof(uint8_t))
-#define EepAdr_u8BrightnessMax       (EepAdr_u8BrightnessMin + sizeof(uint8_t))
-#define EepAdr_u8ColorMode           (EepAdr_u8BrightnessMax + sizeof(uint8_t))
-#define EepAdr_u8Speed               (EepAdr_u8ColorMode + sizeof(uint8_t))
-#define EepAdr_u8MotionOffDelay      (EepAdr_u8Speed + sizeof(uint8_t))
-#define EepAdr_u8DistanceSensorEnabled (EepAdr_u8MotionOffDelay + sizeof(uint8_t))
-#define EepAdr_u8MotionSensorEnabled   (EepAdr_u8DistanceSensorEnabled + sizeof(uint8_t))
-#define EepAdr_u8BrightnessNight     (EepAdr_u8MotionSensorEnabled + sizeof(uint8_t))
-#define EepAdr_dLongitude             (EepAdr_u8BrightnessNight + sizeof(uint8_t))
-#define EepAdr_dLatitude              (EepAdr_dLongitude + sizeof(double))
-#define EepAdr_acTimeZone             (EepAdr_dLatitude + sizeof(double))
-#define EepAdr_acNtpServer1           (EepAdr_acTimeZone + EepStringSize)
-#define EepAdr_acNtpServer2           (EepAdr_acNtpServer1 + EepStringSize)
-#define EepAdr_acTimeZoneName         (EepAdr_acNtpServer2 + EepStringSize)
-#define EepAdr_u8SwitchStatus         (EepAdr_acTimeZoneName + EepStringSize)
-#define EepAdr_u8PowerOnRestoreSwitch (EepAdr_u8SwitchStatus + sizeof(uint8_t))
-
-#define EepAdr_Last                   (EepAdr_acTimeZoneName + sizeof(uint8_t))
-
-//=======================================================================
-Eep::Eep(uint8_t u8NewDebugLevel) {
+#ifdef ARDUINO_ARCH_ESP8266
+extern "C" uint32_t _FS_start;
+#define EepLogFirstSector ((((uint32_t)&_FS_start - 0x40200000UL) / FlashLogSectorSize) - EepLogSectors) // end of the free sketch (OTA) space, below the file system
+#else
+#define EepLogFirstSector 0 // host build: sectors of the flash mock
+#endif
+
+static_assert(sizeof(tEepData) <= EepSize, "EEP values don't fit into the EEP image");
+
+// tEepType of a member type
+constexpr uint8_t u8EepType(const uint8_t *)  { return nEepU8; }
+constexpr uint8_t u8EepType(const uint16_t *) { return nEepU16; }
+constexpr uint8_t u8EepType(const uint32_t *) { return nEepU32; }
+constexpr uint8_t u8EepType(const double *)   { return nEepDouble; }
+constexpr uint8_t u8EepType(const char *)     { return nEepString; }
+constexpr uint8_t u8EepType(const tSegment *) { return nEepSegments; }
+
+#define EepNumField(type, name, key, def, min, max, flags) {#name, key, offsetof(tEepData, name), sizeof(type), u8EepType((type *)0), flags, min, max},
+#define EepArrField(type, name, count, key, def, flags)    {#name, key, offsetof(tEepData, name), sizeof(type) * (count), u8EepType((type *)0), flags, 0, 0},
+static const tEepField astEepFields[nEepFields] PROGMEM = {
+    EepFields(EepNumField, EepArrField)
+};
+
+#define EepNumDefault(type, name, key, def, min, max, flags) def,
+#define EepArrDefault(type, name, count, key, def, flags)    def,
+static const tEepData stEepDefaults PROGMEM = {
+    EepFields(EepNumDefault, EepArrDefault)
+};
+
+//=======================================================================
+static void vGetField(uint8_t u8Field, tEepField &stField) {
+    memcpy_P(&stField, &astEepFields[u8Field], sizeof(tEepField));
+}
+
+//=======================================================================
+// value of an U8/U16/U32 field (little endian as the ESP8266)
+static uint32_t u32GetNumber(const uint8_t *pu8Value, uint16_t u16Size) {
+    uint32_t u32Value = 0;
+    memcpy(&u32Value, pu8Value, u16Size);
+    return u32Value;
+}
+
+//=======================================================================
+Eep::Eep(uint8_t u8NewDebugLevel) : cFlashLog(u8NewDebugLevel) {
     u8DebugLevel = u8NewDebugLevel;
 }
 
 //=======================================================================
 void Eep::vInit(class NtpTime *pNewNtpTime) {
     pNtpTime = pNewNtpTime;
-    uint32_t u32ChipId = 0;
 
-    EEPROM.begin(512);
-    EEPROM.get(EepAdr_ChipId, u32ChipId); // try to read ChipId from Eep
+    EEPROM.begin(EepSize); // RAM image, loaded from the EEPROM sector
+    boLog = (ESP.getSketchSize() <= EepLogFirstSector * FlashLogSectorSize);
+    if (boLog && !cFlashLog.boInit(EepLogFirstSector, EepLogSectors, EEPROM.getDataPtr(), EepSize)) {
+        // no log yet, the content of the EEPROM sector becomes its first snapshot
+        boLog = cFlashLog.boWrite();
+    }
+    EEPROM.get(0, static_cast<tEepData &>(*this)); // all values in one block
 
     if (u32ChipId != ESP.getChipId()) {
         // eep not initialized, write default values
         vFactoryReset();
     }
 
-    // get all values
-    EEPROM.get(EepAdr_ChipId, u32ChipId);
-    EEPROM.get(EepAdr_u16CalibrationValue, u16CalibrationValue);
-    EEPROM.get(EepAdr_u16LedCount, u16LedCount);
-    EEPROM.get(EepAdr_u16Hue, u16Hue);
-    EEPROM.get(EepAdr_u8Saturation, u8Saturation);
-    EEPROM.get(EepAdr_u8BrightnessDay, u8BrightnessDay);
-    EEPROM.get(EepAdr_u8BrightnessNight, u8BrightnessNight);
-    EEPROM.get(EepAdr_u8BrightnessMin, u8BrightnessMin);
-    EEPROM.get(EepAdr_u8BrightnessMax, u8BrightnessMax);
-    EEPROM.get(EepAdr_u8DimMode, u8DimMode);
-    EEPROM.get(EepAdr_u8WiFiApMode, u8WiFiApMode);
-    EEPROM.get(EepAdr_u8ColorMode, u8ColorMode); u8ColorMode = (u8ColorMode >= nNoMode) ? nNoMode - 1 : u8ColorMode;
-    EEPROM.get(EepAdr_u8Speed, u8Speed);
-    EEPROM.get(EepAdr_u8MotionOffDelay, u8MotionOffDelay);
-    EEPROM.get(EepAdr_u8DistanceSensorEnabled, u8DistanceSensorEnabled);
-    EEPROM.get(EepAdr_u8MotionSensorEnabled, u8MotionSensorEnabled);
-    EEPROM.get(EepAdr_dLongitude, dLongitude);
-    EEPROM.get(EepAdr_dLatitude, dLatitude);
-    EEPROM.get(EepAdr_acTimeZoneName, acTimeZoneName); acTimeZoneName[EepStringSize - 1] = 0;
-    EEPROM.get(EepAdr_acTimeZone, acTimeZone); acTimeZone[EepStringSize - 1] = 0;
-    EEPROM.get(EepAdr_acNtpServer1, acNtpServer1); acNtpServer1[EepStringSize - 1] = 0;
-    EEPROM.get(EepAdr_acNtpServer2, acNtpServer2); acNtpServer2[EepStringSize - 1] = 0;
-    EEPROM.get(EepAdr_u8SwitchStatus, u8SwitchStatus);
-    EEPROM.get(EepAdr_u8PowerOnRestoreSwitch, u8PowerOnRestoreSwitch);
+    // values out of their range (not initialized, older firmware): default
+    uint8_t *pu8Data = (uint8_t *)static_cast<tEepData *>(this);
+    tEepField stField;
+    for (uint8_t u8Field = 0; u8Field < nEepFields; u8Field++) {
+        vGetField(u8Field, stField);
+        if (stField.u8Flags & EepInternal) continue;
+        uint8_t *pu8Value = pu8Data + stField.u16Offset;
+        bool boValid = true;
+        switch (stField.u8Type) {
+            case nEepU8:
+            case nEepU16:
+            case nEepU32: {
+                uint32_t u32Value = u32GetNumber(pu8Value, stField.u16Size);
+                boValid = (u32Value >= (uint32_t)stField.i32Min) && (u32Value <= (uint32_t)stField.i32Max);
+                break;
+            }
+            case nEepDouble: {
+                double dValue;
+                memcpy(&dValue, pu8Value, sizeof(dValue));
+                boValid = (dValue >= stField.i32Min) && (dValue <= stField.i32Max); // false for NaN
+                break;
+            }
+            case nEepString:
+                pu8Value[stField.u16Size - 1] = 0;
+                break;
+            case nEepSegments:
+                // one invalid segment resets all, the stripe is used as a whole
+                for (uint8_t u8Idx = 0; boValid && (u8Idx < SegmentsMax); u8Idx++) {
+                    tSegment stSegment;
+                    memcpy(&stSegment, pu8Value + u8Idx * sizeof(tSegment), sizeof(tSegment));
+                    boValid =    (stSegment.u8ColorMode < nNoMode)
+                              && (((uint32_t)stSegment.u16Start + stSegment.u16Count) <= u16LedCount);
+                }
+                if (!boValid) u8SegmentCount = 0;
+                break;
+        }
+        if (!boValid) {
+            memcpy_P(pu8Value, (const uint8_t *)&stEepDefaults + stField.u16Offset, stField.u16Size);
+        }
+    }
+    if (!u8MatrixWidth || !u8MatrixHeight) {
+        // not initialized or invalid: linear stripe
+        u8MatrixWidth  = 0;
+        u8MatrixHeight = 0;
+        u8MatrixLayout = nRowMajor;
+    }
 
     if (u8DebugLevel & DEBUG_EEP_EVENTS) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Read Adr:0x%04X u32ChipId               = 0x%08X ", EepAdr_ChipId, u32ChipId); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u16CalibrationValue     = %d ", EepAdr_u16CalibrationValue, u16CalibrationValue); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u16LedCount             = %d ", EepAdr_u16LedCount, u16LedCount); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u16Hue                  = 0x%04X ", EepAdr_u16Hue, u16Hue); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8Saturation            = 0x%02X ", EepAdr_u8Saturation, u8Saturation); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8BrightnessDay         = 0x%02X ", EepAdr_u8BrightnessDay, u8BrightnessDay); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8BrightnessNight       = 0x%02X ", EepAdr_u8BrightnessNight, u8BrightnessNight); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8BrightnessMin         = %d ", EepAdr_u8BrightnessMin, u8BrightnessMin); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8BrightnessMax         = %d ", EepAdr_u8BrightnessMax, u8BrightnessMax); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8DimMode               = 0x%02X ", EepAdr_u8DimMode, u8DimMode); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8WiFiApMode            = 0x%02X ", EepAdr_u8WiFiApMode, u8WiFiApMode); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8ColorMode             = %d ", EepAdr_u8ColorMode, u8ColorMode); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8Speed                 = %d ", EepAdr_u8Speed, u8Speed); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8MotionOffDelay        = %d [s]", EepAdr_u8MotionOffDelay, u8MotionOffDelay); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8DistanceSensorEnabled = %d", EepAdr_u8DistanceSensorEnabled, u8DistanceSensorEnabled); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8MotionSensorEnabled   = %d", EepAdr_u8MotionSensorEnabled, u8MotionSensorEnabled); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X dLongitude              = %f", EepAdr_dLongitude, dLongitude); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X dLatitude               = %f", EepAdr_dLatitude, dLatitude); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X acTimeZoneName          = %s", EepAdr_acTimeZoneName, acTimeZoneName); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X acTimeZone              = %s", EepAdr_acTimeZone, acTimeZone); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X acNtpServer1            = %s", EepAdr_acNtpServer1, acNtpServer1); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X acNtpServer2            = %s", EepAdr_acNtpServer2, acNtpServer2); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8SwitchStatus          = %d ", EepAdr_u8SwitchStatus, u8SwitchStatus); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Read Adr:0x%04X u8PowerOnRestoreSwitch  = %d ", EepAdr_u8PowerOnRestoreSwitch, u8PowerOnRestoreSwitch); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+        vDump("Read");
     }
 }
 //=======================================================================
 void Eep::vFactoryReset() {
-
-    EEPROM.put(EepAdr_ChipId, ESP.getChipId()); // ChipId
-    vSetLedCount(300, false);                   // number of current configured LEDs (0..65535 default:300)
-    vSetCalibrationValue(200, false);           // distance sensor calibration value (0..65535 default:200)
-    vSetHue(0, false);                          // color hue (0..65535 default:0)
-    vSetSaturation(0, false);                   // color saturation value (0..65535 default:0)
-    vSetBrightnessDay(128, false);              // color brightness (0..255 default_128)
-    vSetDimMode(1, false);                      // 0:brightness ++ or -- 1:brightness via distance
-    char acWifiSsid[EepStringSize];
-    char acWifiPwd[EepStringSize];
-    for (int i = 0; i < EepStringSize - 1; i++) {
-        acWifiSsid[i] = 0;
-        acWifiPwd[i] = 0;
-    }
-    vSetWifiSsidPwd(acWifiSsid, acWifiPwd, false); // set wifi SSID und Pwd
-    vSetWiFiMode(1, false);                     // wifi mode (0:SSID 1:AP default:1)
-    vSetBrightnessMin(18, false);               // LED min brightness (0..255 default:24)
-    vSetBrightnessMax(0xff, false);             // LED max brightness (0..255 default:255)
-    vSetColorMode(0, false);                    // color mode (0..2 default:0)
-    vSetSpeed(128, false);                      // speed (1..255 default:128)
-    vSetMotionOffDelay(60 - EepMotionOffDelayMin, false); // off delay (1..255 default:60)
-    vSetDistanceSensorEnabled(0, false);        // enable/disable distance sensor (0..255 default:0)
-    vSetMotionSensorEnabled(1, false);          // enable/disable motion sensor (0..255 default:1)
-    vSetBrightnessNight(128, false);            // color brightness (0..255 default_128)
-    vSetLongitude(0, false);                    // store longitude
-    vSetLatitude(0, false);                     // store latitude
-    vSetNtp(                                       // se initially NTP values
-        "Europe/BerlinTimeZone:CET-1CEST,M3.5.0,M10.5.0/3NTP",
-        "CET-1CEST,M3.5.0,M10.5.0/3",
-        "ptbtime1.ptb.de",
-        "ptbtime2.ptb.de",
-        false
-    );
-    vSetSwitchStatus(0, false); // last switch status (0..1 default:0)
-    vSetPowerOnRestoreSwitch(0, false); // restore switch status after PowerOn (0..1 default:0)
+    tEepData stDefaults;
+    memcpy_P(&stDefaults, &stEepDefaults, sizeof(tEepData));
+    stDefaults.u32ChipId = ESP.getChipId();
+    static_cast<tEepData &>(*this) = stDefaults;
+    EEPROM.put(0, stDefaults); // all values in one block
+    vMarkDirty();
 
     if (u8DebugLevel & DEBUG_EEP_EVENTS) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X u32ChipId               = 0x%08X ",EepAdr_ChipId, ESP.getChipId()); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u16CalibrationValue     = %d ", EepAdr_u16CalibrationValue, u16CalibrationValue); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u16LedCount             = %d ", EepAdr_u16LedCount, u16LedCount); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u16Hue                  = 0x%04X ", EepAdr_u16Hue, u16Hue); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8Saturation            = 0x%02X ", EepAdr_u8Saturation, u8Saturation); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8BrightnessDay         = 0x%02X ", EepAdr_u8BrightnessDay, u8BrightnessDay); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8BrightnessNight       = 0x%02X ", EepAdr_u8BrightnessNight, u8BrightnessNight); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8BrightnessMin         = %d ", EepAdr_u8BrightnessMin, u8BrightnessMin); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8BrightnessMax         = %d ", EepAdr_u8BrightnessMax, u8BrightnessMax); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8DimMode               = 0x%02X ", EepAdr_u8DimMode, u8DimMode); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8WiFiApMode            = 0x%02X ", EepAdr_u8WiFiApMode, u8WiFiApMode); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8ColorMode             = %d ", EepAdr_u8ColorMode, u8ColorMode); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8Speed                 = %d ", EepAdr_u8Speed, u8Speed); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8MotionOffDelay        = %d ", EepAdr_u8MotionOffDelay, u8MotionOffDelay); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8DistanceSensorEnabled = %d ", EepAdr_u8DistanceSensorEnabled, u8DistanceSensorEnabled); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8MotionSensorEnabled   = %d ", EepAdr_u8MotionSensorEnabled, u8MotionSensorEnabled); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X dLongitude              = %f", EepAdr_dLongitude, dLongitude); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X dLatitude               = %f", EepAdr_dLatitude, dLatitude); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acWifiSsid              = %s ", EepAdr_acWifiSsid, acWifiSsid); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acWifiPwd               = %s ", EepAdr_acWifiPwd, acWifiPwd); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acTimeZoneName          = %s", EepAdr_acTimeZoneName, acTimeZoneName); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acTimeZone              = %s", EepAdr_acTimeZone, acTimeZone); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acNtpServer1            = %s", EepAdr_acNtpServer1, acNtpServer1); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acNtpServer2            = %s", EepAdr_acNtpServer2, acNtpServer2); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8SwitchStatus          = 0x%02X ", EepAdr_u8SwitchStatus, u8SwitchStatus); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X u8PowerOnRestoreSwitch  = 0x%02X ", EepAdr_u8PowerOnRestoreSwitch, u8PowerOnRestoreSwitch); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+        vDump("Write");
     }
+    vFlush();      // the restart must not lose the defaults
     ESP.restart(); // reset
 }
 
 //=======================================================================
-void Eep::vSetHue(uint16_t u16NewHue, bool boPrintConsole) {
-    uint16_t u16Hue_Tmp = 0;
-    bool     boUpdated  = false;
-    u16Hue = u16NewHue;
-    EEPROM.get(EepAdr_u16Hue, u16Hue_Tmp);
-    if (u16Hue_Tmp != u16Hue) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u16Hue, u16Hue);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u16Hue = 0x%04X ", EepAdr_u16Hue, boUpdated ? "updated" : "unchanged", u16Hue); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+// a setter changed the EEP image, the commit waits until the values are quiet
+void Eep::vMarkDirty() {
+    if (boDirty) {
+        u32CommitsAvoided++; // merged into the pending commit
     }
+    boDirty     = true;
+    ulDirtyTime = millis();
 }
+
 //=======================================================================
-void Eep::vSetSaturation(uint8_t u8NewSaturation, bool boPrintConsole) {
-    uint8_t u8Saturation_Tmp = 0;
-    bool    boUpdated        = false;
-    u8Saturation = u8NewSaturation;
-    EEPROM.get(EepAdr_u8Saturation, u8Saturation_Tmp);
-    if (u8Saturation_Tmp != u8Saturation) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8Saturation,        u8Saturation);
-        EEPROM.commit();
-        boUpdated = true;
+// commit the pending changes, EepCommitDelay after the last change
+void Eep::vLoop() {
+    if (boDirty && ((millis() - ulDirtyTime) >= EepCommitDelay)) {
+        vFlush();
     }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
+}
+
+//=======================================================================
+// commit the pending changes at once, call it before a restart
+void Eep::vFlush() {
+    if (!boDirty) return;
+    if (!boLog) {
+        EEPROM.commit(); // no space for the log below the file system
+    } else if (!cFlashLog.boWrite()) {
+        ulDirtyTime = millis(); // flash error, retry after EepCommitDelay
+        vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, "Eep.Commit flash error");
+        return;
+    }
+    boDirty = false;
+    u32Commits++;
+    if (u8DebugLevel & DEBUG_EEP_EVENTS) {
         char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8Saturation = 0x%02X ", EepAdr_u8Saturation, boUpdated ? "updated" : "unchanged", u8Saturation); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+        sprintf(buffer, "Eep.Commit commits:%lu avoided:%lu erases:%lu ", (unsigned long)u32Commits, (unsigned long)u32CommitsAvoided, (unsigned long)u32GetErases()); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
     }
 }
+
 //=======================================================================
-void Eep::vSetBrightnessDay(uint8_t u8NewBrightness, bool boPrintConsole) {
-    uint8_t  u8Brightness_Tmp = 0;
-    bool     boUpdated        = false;
-    u8BrightnessDay = u8NewBrightness;
-    EEPROM.get(EepAdr_u8BrightnessDay, u8Brightness_Tmp);
-    if (u8Brightness_Tmp != u8BrightnessDay) {
+uint32_t Eep::u32GetCommits() {
+    return u32Commits;
+}
+
+//=======================================================================
+uint32_t Eep::u32GetCommitsAvoided() {
+    return u32CommitsAvoided;
+}
+
+//=======================================================================
+uint32_t Eep::u32GetErases() {
+    return boLog ? cFlashLog.u32GetErases() : u32Commits;
+}
+
+//=======================================================================
+// copy a value (or a part of it) into the member and the EEP image, the
+// image is only marked dirty, when a byte changed
+void Eep::vStore(uint8_t u8Field, uint16_t u16Pos, const void *pvValue, uint16_t u16Size, bool boPrintConsole) {
+    tEepField stField;
+    vGetField(u8Field, stField);
+    uint16_t u16Adr  = stField.u16Offset + u16Pos;
+    uint8_t *pu8Data = (uint8_t *)static_cast<tEepData *>(this) + u16Adr;
+    uint8_t *pu8Eep  = EEPROM.getDataPtr() + u16Adr;
+    bool boUpdated   = false;
+    memmove(pu8Data, pvValue, u16Size); // store new value in RAM
+    if (memcmp(pu8Eep, pu8Data, u16Size)) {
         // at least one value changed
-        EEPROM.put(EepAdr_u8BrightnessDay, u8BrightnessDay);
-        EEPROM.commit();
+        memcpy(pu8Eep, pu8Data, u16Size);
+        vMarkDirty();
         boUpdated = true;
     }
-
     if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8BrightnessDay = 0x%02X ", EepAdr_u8BrightnessDay, boUpdated ? "updated" : "unchanged", u8BrightnessDay); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+        vPrintField(u8Field, boUpdated ? "Write updated" : "Write unchanged");
     }
 }
 
 //=======================================================================
-void Eep::vSetBrightnessNight(uint8_t u8NewBrightness, bool boPrintConsole) {
-    uint8_t  u8Brightness_Tmp = 0;
-    bool     boUpdated        = false;
-    u8BrightnessNight = u8NewBrightness;
-    EEPROM.get(EepAdr_u8BrightnessNight, u8Brightness_Tmp);
-    if (u8Brightness_Tmp != u8BrightnessNight) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8BrightnessNight, u8BrightnessNight);
-        EEPROM.commit();
-        boUpdated = true;
+void Eep::vSetNumber(uint8_t u8Field, int32_t i32Value, bool boPrintConsole) {
+    tEepField stField;
+    vGetField(u8Field, stField);
+    if (!(stField.u8Flags & EepInternal)) {
+        if (i32Value < stField.i32Min) i32Value = stField.i32Min;
+        if (i32Value > stField.i32Max) i32Value = stField.i32Max;
+    }
+    vStore(u8Field, 0, &i32Value, stField.u16Size, boPrintConsole); // low bytes (little endian)
+}
+
+//=======================================================================
+void Eep::vSetDouble(uint8_t u8Field, double dValue, bool boPrintConsole) {
+    tEepField stField;
+    vGetField(u8Field, stField);
+    if (!(dValue >= stField.i32Min)) dValue = stField.i32Min; // NaN: min
+    if (dValue > stField.i32Max)     dValue = stField.i32Max;
+    vStore(u8Field, 0, &dValue, sizeof(dValue), boPrintConsole);
+}
+
+//=======================================================================
+// the value may be the member itself, it's copied into a zero filled buffer first
+void Eep::vSetString(uint8_t u8Field, const char *pcValue, bool boPrintConsole) {
+    tEepField stField;
+    vGetField(u8Field, stField);
+    char acValue[EepStringSize];
+    memset(acValue, 0, sizeof(acValue));
+    strncpy(acValue, pcValue, stField.u16Size - 1);
+    vStore(u8Field, 0, acValue, stField.u16Size, boPrintConsole);
+}
+
+//=======================================================================
+void Eep::vPrintField(uint8_t u8Field, const char *pcAction) {
+    tEepField stField;
+    vGetField(u8Field, stField);
+    const uint8_t *pu8Value = (const uint8_t *)static_cast<tEepData *>(this) + stField.u16Offset;
+    char buffer[100];
+    switch (stField.u8Type) {
+        case nEepDouble: {
+            double dValue;
+            memcpy(&dValue, pu8Value, sizeof(dValue));
+            snprintf(buffer, sizeof(buffer), "Eep.%s Adr:0x%04X %-23s = %f", pcAction, stField.u16Offset, stField.acName, dValue);
+            break;
+        }
+        case nEepString:
+            snprintf(buffer, sizeof(buffer), "Eep.%s Adr:0x%04X %-23s = %s", pcAction, stField.u16Offset, stField.acName, (const char *)pu8Value);
+            break;
+        case nEepSegments:
+            for (uint8_t u8Idx = 0; u8Idx < u8SegmentCount; u8Idx++) {
+                snprintf(buffer, sizeof(buffer), "Eep.%s Adr:0x%04X astSegments[%d] = %d+%d M:%d H:0x%04X S:0x%02X V:%d B:0x%02X", pcAction,
+                    (int)(stField.u16Offset + u8Idx * sizeof(tSegment)), u8Idx,
+                    astSegments[u8Idx].u16Start, astSegments[u8Idx].u16Count, astSegments[u8Idx].u8ColorMode, astSegments[u8Idx].u16Hue,
+                    astSegments[u8Idx].u8Saturation, astSegments[u8Idx].u8Speed, astSegments[u8Idx].u8Brightness);
+                vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+            }
+            return;
+        default:
+            snprintf(buffer, sizeof(buffer), "Eep.%s Adr:0x%04X %-23s = %lu", pcAction, stField.u16Offset, stField.acName, (unsigned long)u32GetNumber(pu8Value, stField.u16Size));
+            break;
+    }
+    vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+}
+
+//=======================================================================
+void Eep::vDump(const char *pcAction) {
+    for (uint8_t u8Field = 0; u8Field < nEepFields; u8Field++) {
+        vPrintField(u8Field, pcAction);
     }
+}
 
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8BrightnessNight = 0x%02X ", EepAdr_u8BrightnessNight, boUpdated ? "updated" : "unchanged", u8BrightnessNight); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+//=======================================================================
+// segments: [[start, count, colorMode, hue, sat, speed, bri], ...] of the used ones
+void Eep::vExport(JsonObject stJson) {
+    const uint8_t *pu8Data = (const uint8_t *)static_cast<tEepData *>(this);
+    tEepField stField;
+    for (uint8_t u8Field = 0; u8Field < nEepFields; u8Field++) {
+        vGetField(u8Field, stField);
+        if (stField.u8Flags & (EepInternal | EepSecret)) continue;
+        const uint8_t *pu8Value = pu8Data + stField.u16Offset;
+        switch (stField.u8Type) {
+            case nEepDouble: {
+                double dValue;
+                memcpy(&dValue, pu8Value, sizeof(dValue));
+                stJson[stField.acKey] = dValue;
+                break;
+            }
+            case nEepString:
+                stJson[stField.acKey] = (const char *)pu8Value;
+                break;
+            case nEepSegments: {
+                JsonArray stSegments = stJson[stField.acKey].to<JsonArray>();
+                for (uint8_t u8Idx = 0; u8Idx < u8SegmentCount; u8Idx++) {
+                    JsonArray stSegment = stSegments.add<JsonArray>();
+                    stSegment.add(astSegments[u8Idx].u16Start);
+                    stSegment.add(astSegments[u8Idx].u16Count);
+                    stSegment.add(astSegments[u8Idx].u8ColorMode);
+                    stSegment.add(astSegments[u8Idx].u16Hue);
+                    stSegment.add(astSegments[u8Idx].u8Saturation);
+                    stSegment.add(astSegments[u8Idx].u8Speed);
+                    stSegment.add(astSegments[u8Idx].u8Brightness);
+                }
+                break;
+            }
+            default:
+                stJson[stField.acKey] = u32GetNumber(pu8Value, stField.u16Size);
+                break;
+        }
     }
 }
+
+//=======================================================================
+void Eep::vSetHue(uint16_t u16NewHue, bool boPrintConsole) {
+    vSetNumber(nEep_u16Hue, u16NewHue, boPrintConsole);
+}
+//=======================================================================
+void Eep::vSetSaturation(uint8_t u8NewSaturation, bool boPrintConsole) {
+    vSetNumber(nEep_u8Saturation, u8NewSaturation, boPrintConsole);
+}
+//=======================================================================
+void Eep::vSetBrightnessDay(uint8_t u8NewBrightness, bool boPrintConsole) {
+    vSetNumber(nEep_u8BrightnessDay, u8NewBrightness, boPrintConsole);
+}
+
+//=======================================================================
+void Eep::vSetBrightnessNight(uint8_t u8NewBrightness, bool boPrintConsole) {
+    vSetNumber(nEep_u8BrightnessNight, u8NewBrightness, boPrintConsole);
+}
 //=======================================================================
 void Eep::vSetDimMode(uint8_t u8NewDimMode, bool boPrintConsole) {
-    uint8_t  u8DimMode_Tmp = 0;
-    bool boUpdated          = false;
-    u8DimMode = u8NewDimMode;
-    EEPROM.get(EepAdr_u8DimMode, u8DimMode_Tmp);
-    if (u8DimMode_Tmp != u8DimMode) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8DimMode, u8DimMode);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8DimMode = 0x%02X ", EepAdr_u8DimMode, boUpdated ? "updated" : "unchanged", u8DimMode); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8DimMode, u8NewDimMode, boPrintConsole);
 }
 //=======================================================================
-void Eep::vSetCalibrationValue(volatile uint16_t u16NewCalibrationValue, bool boPrintConsole) {
-    uint16_t u16CalibrationValue_Tmp = 0;
-    bool     boUpdated               = false;
-    u16CalibrationValue = u16NewCalibrationValue;
-    EEPROM.get(EepAdr_u16CalibrationValue, u16CalibrationValue_Tmp);
-    if (u16CalibrationValue_Tmp != u16CalibrationValue) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u16CalibrationValue, u16CalibrationValue);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u16CalibrationValue = %d ", EepAdr_u16CalibrationValue, boUpdated ? "updated" : "unchanged", u16CalibrationValue); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+void Eep::vSetCalibrationValue(uint16_t u16NewCalibrationValue, bool boPrintConsole) {
+    vSetNumber(nEep_u16CalibrationValue, u16NewCalibrationValue, boPrintConsole);
 }
 
 //=======================================================================
 void Eep::vGetWifiSsid(char *pWifiSsid) {
-    // reat SSID byte-by-byte to EEPROM
-    for (int i = 0; i < EepStringSize; i++) {
-        pWifiSsid[i] = EEPROM.read(EepAdr_acWifiSsid + i);
-    }
+    memcpy(pWifiSsid, acWifiSsid, EepStringSize);
     if (u8DebugLevel & DEBUG_EEP_EVENTS) {
         char buffer[100];
-        sprintf(buffer, "Eep.Read Adr:0x%04X acWifiSsid = %s length:%d", EepAdr_acWifiSsid, pWifiSsid, String(pWifiSsid).length()); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+        sprintf(buffer, "Eep.Read Adr:0x%04X acWifiSsid = %s length:%d", (int)offsetof(tEepData, acWifiSsid), pWifiSsid, String(pWifiSsid).length()); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
     }
 }
 void Eep::vGetWifiPwd(char *pWifiPwd) {
-    // read PWD byte-by-byte to EEPROM
-    for (int i = 0; i < EepStringSize; i++) {
-        pWifiPwd[i] = EEPROM.read(EepAdr_acWifiPwd + i);
-    }
+    memcpy(pWifiPwd, acWifiPwd, EepStringSize);
     if (u8DebugLevel & DEBUG_EEP_EVENTS) {
         char buffer[100];
-        sprintf(buffer, "Eep.Read Adr:0x%04X acWifiPwd = %s length:%d", EepAdr_acWifiPwd, pWifiPwd, String(pWifiPwd).length()); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+        sprintf(buffer, "Eep.Read Adr:0x%04X acWifiPwd = %s length:%d", (int)offsetof(tEepData, acWifiPwd), pWifiPwd, String(pWifiPwd).length()); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
     }
 }
 void Eep::vSetWifiSsidPwd(char *pNewWifiSsid, char *pNewWifiPwd, bool boPrintConsole) {
-    for (int i = 0; i < EepStringSize; i++) {
-        EEPROM.write(EepAdr_acWifiSsid + i, pNewWifiSsid[i]);
-        EEPROM.write(EepAdr_acWifiPwd + i, pNewWifiPwd[i]);
-    }
-    EEPROM.commit();
-
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X acWifiSsid = %s ", EepAdr_acWifiSsid, pNewWifiSsid); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acWifiPwd  = %s ", EepAdr_acWifiPwd, pNewWifiPwd); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetString(nEep_acWifiSsid, pNewWifiSsid, boPrintConsole);
+    vSetString(nEep_acWifiPwd, pNewWifiPwd, boPrintConsole);
 }
 
 //=======================================================================
 void Eep::vSetWiFiMode(uint8_t u8NewWiFiMode, bool boPrintConsole) {
-    uint8_t u8WiFiApMode_Tmp = 0;
-    bool boUpdated           = false;
-    u8WiFiApMode = u8NewWiFiMode;
-    EEPROM.get(EepAdr_u8WiFiApMode, u8WiFiApMode_Tmp); // read the current LedCount
-    if (u8WiFiApMode_Tmp != u8WiFiApMode) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8WiFiApMode, u8WiFiApMode);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8WiFiApMode = %d ", EepAdr_u8WiFiApMode, boUpdated ? "updated" : "unchanged", u8WiFiApMode);
-        vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8WiFiApMode, u8NewWiFiMode, boPrintConsole);
 }
 
 //=======================================================================
 void Eep::vSetColorMode(uint8_t u8NewColorMode, bool boPrintConsole) {
-    uint8_t u8ColorMode_Tmp = 0;
-    bool boUpdated          = false;
-    u8ColorMode = u8NewColorMode;
-    EEPROM.get(EepAdr_u8ColorMode, u8ColorMode_Tmp); // read the current LedCount
-    if (u8ColorMode_Tmp != u8ColorMode) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8ColorMode, u8ColorMode);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8ColorMode = %d ", EepAdr_u8ColorMode, boUpdated ? "updated" : "unchanged", u8ColorMode);
-        vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8ColorMode, u8NewColorMode, boPrintConsole);
 }
 
 //=======================================================================
 void Eep::vSetSpeed(uint8_t u8NewSpeed, bool boPrintConsole) {
-    uint8_t u8Speed_Tmp = 0;
-    bool boUpdated      = false;
-    u8Speed = u8NewSpeed;
-    EEPROM.get(EepAdr_u8Speed, u8Speed_Tmp); // read the current LedCount
-    if (u8Speed_Tmp != u8Speed) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8Speed, u8Speed);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8Speed = %d ", EepAdr_u8Speed, boUpdated ? "updated" : "unchanged", u8Speed); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8Speed, u8NewSpeed, boPrintConsole);
 }
 
 //=======================================================================
 void Eep::vSetDistanceSensorEnabled(uint8_t u8NewDistanceSensorEnabled, bool boPrintConsole) {
-    uint8_t u8DistanceSensorEnabled_Tmp = 0;
-    bool boUpdated                    = false;
-    u8DistanceSensorEnabled = u8NewDistanceSensorEnabled;
-    EEPROM.get(EepAdr_u8DistanceSensorEnabled, u8DistanceSensorEnabled_Tmp); // read the current LedCount
-    if (u8DistanceSensorEnabled_Tmp != u8DistanceSensorEnabled) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8DistanceSensorEnabled, u8DistanceSensorEnabled);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8DistanceSensorEnabled = %d ", EepAdr_u8DistanceSensorEnabled, boUpdated ? "updated" : "unchanged", u8DistanceSensorEnabled); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8DistanceSensorEnabled, u8NewDistanceSensorEnabled, boPrintConsole);
 }
 
 //=======================================================================
 void Eep::vSetMotionSensorEnabled(uint8_t u8NewMotionSensorEnabled, bool boPrintConsole) {
-    uint8_t u8MotionSensorEnabled_Tmp = 0;
-    bool boUpdated                  = false;
-    u8MotionSensorEnabled = u8NewMotionSensorEnabled;
-    EEPROM.get(EepAdr_u8MotionSensorEnabled, u8MotionSensorEnabled_Tmp); // read the current LedCount
-    if (u8MotionSensorEnabled_Tmp != u8MotionSensorEnabled) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8MotionSensorEnabled, u8MotionSensorEnabled);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8MotionSensorEnabled = %d ", EepAdr_u8MotionSensorEnabled, boUpdated ? "updated" : "unchanged", u8MotionSensorEnabled); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8MotionSensorEnabled, u8NewMotionSensorEnabled, boPrintConsole);
 }
 
 //=======================================================================
 void Eep::vSetMotionOffDelay(uint8_t u8NewMotionOffDelay, bool boPrintConsole) {
-    uint8_t u8MotionOffDelay_Tmp = 0;
-    bool boUpdated               = false;
-    u8MotionOffDelay = u8NewMotionOffDelay;
-    EEPROM.get(EepAdr_u8MotionOffDelay, u8MotionOffDelay_Tmp); // read the current LedCount
-    if (u8MotionOffDelay_Tmp != u8MotionOffDelay) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8MotionOffDelay, u8MotionOffDelay);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8MotionOffDelay = %d ", EepAdr_u8MotionOffDelay, boUpdated ? "updated" : "unchanged", u8MotionOffDelay); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8MotionOffDelay, u8NewMotionOffDelay, boPrintConsole);
 }
 
 //=======================================================================
 void Eep::vSetLedCount( uint16_t u16NewLedCount, bool boPrintConsole) {
-    uint16_t u16LedCount_Tmp = 0;
-    bool boUpdated           = false;
-    u16LedCount = u16NewLedCount; // store new vale in RAM
-    EEPROM.get(EepAdr_u16LedCount, u16LedCount_Tmp); // read the current LedCount
-    if (u16LedCount_Tmp != u16LedCount) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u16LedCount, u16LedCount);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u16LedCount = %d ", EepAdr_u16LedCount, boUpdated ? "updated" : "unchanged", u16LedCount);
-        vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u16LedCount, u16NewLedCount, boPrintConsole);
 }
 void Eep::vSetBrightnessMin( uint8_t u8NewBrightnessMin, bool boPrintConsole) {
-    uint16_t u8BrightnessMin_Tmp = 0;
-    bool boUpdated               = false;
-    u8BrightnessMin = u8NewBrightnessMin; // store new vale in RAM
-    EEPROM.get(EepAdr_u8BrightnessMin, u8BrightnessMin_Tmp); // read the current value from EEP
-    if (u8BrightnessMin_Tmp != u8BrightnessMin) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8BrightnessMin, u8BrightnessMin); // store new value in EEP
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8BrightnessMin = %d ", EepAdr_u8BrightnessMin, boUpdated ? "updated" : "unchanged", u8BrightnessMin);
-        vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8BrightnessMin, u8NewBrightnessMin, boPrintConsole);
 }
 void Eep::vSetBrightnessMax( uint8_t u8NewBrightnessMax, bool boPrintConsole) {
-    uint16_t u8BrightnessMax_Tmp = 0;
-    bool boUpdated               = false;
-    u8BrightnessMax = u8NewBrightnessMax; // store new vale in RAM
-    EEPROM.get(EepAdr_u8BrightnessMax, u8BrightnessMax_Tmp); // read the current value from EEP
-    if (u8BrightnessMax_Tmp != u8BrightnessMax) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8BrightnessMax, u8BrightnessMax); // store new value in EEP
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8BrightnessMax = %d ", EepAdr_u8BrightnessMax, boUpdated ? "updated" : "unchanged", u8BrightnessMax);
-        vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8BrightnessMax, u8NewBrightnessMax, boPrintConsole);
 }
 //#############################################################################
 void Eep::vSetLongitude(double dNewLongitude, bool boPrintConsole) {
-    uint16_t dLongitude_Tmp = 0;
-    bool boUpdated               = false;
-    dLongitude = dNewLongitude;                    // store new vale in RAM
-    EEPROM.get(EepAdr_dLongitude, dLongitude_Tmp); // read the current value from EEP
-    if (dLongitude_Tmp != dLongitude) {
-        // at least one value changed
-        EEPROM.put(EepAdr_dLongitude, dLongitude); // store new value in EEP
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s dLongitude = %f ", EepAdr_dLongitude, boUpdated ? "updated" : "unchanged", dLongitude);
-        vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetDouble(nEep_dLongitude, dNewLongitude, boPrintConsole);
 }
 void Eep::vSetLatitude(double dNewLatitude, bool boPrintConsole) {
-    uint16_t dLatitude_Tmp = 0;
-    bool boUpdated               = false;
-    dLatitude = dNewLatitude;                    // store new vale in RAM
-    EEPROM.get(EepAdr_dLatitude, dLatitude_Tmp); // read the current value from EEP
-    if (dLatitude_Tmp != dLatitude) {
-        // at least one value changed
-        EEPROM.put(EepAdr_dLatitude, dLatitude); // store new value in EEP
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s dLatitude = %f ", EepAdr_dLatitude, boUpdated ? "updated" : "unchanged", dLatitude);
-        vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetDouble(nEep_dLatitude, dNewLatitude, boPrintConsole);
 }
 void Eep::vSetNtp(char *pNewTimeZoneName, char *pNewTimeZone, char *newNtpServer1, char *newNtpServer2, bool boPrintConsole) {
-    for (int i = 0; i < EepStringSize; i++) {
-        acTimeZoneName[i] = pNewTimeZoneName[i];  EEPROM.write(EepAdr_acTimeZoneName + i, acTimeZoneName[i]);
-        acTimeZone[i]     = pNewTimeZone[i];      EEPROM.write(EepAdr_acTimeZone + i,     acTimeZone[i]);
-        acNtpServer1[i]   = newNtpServer1[i];     EEPROM.write(EepAdr_acNtpServer1 + i,   acNtpServer1[i]);
-        acNtpServer2[i]   = newNtpServer2[i];     EEPROM.write(EepAdr_acNtpServer2 + i,   acNtpServer2[i]);
-    }
-    EEPROM.commit();
-
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X acTimeZoneName = %s", EepAdr_acTimeZoneName, acTimeZoneName); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acTimeZone     = %s", EepAdr_acTimeZone, acTimeZone); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acNtpServer1   = %s", EepAdr_acNtpServer1, acNtpServer1); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-        sprintf(buffer, "Eep.Write Adr:0x%04X acNtpServer2   = %s", EepAdr_acNtpServer2, acNtpServer2); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetString(nEep_acTimeZoneName, pNewTimeZoneName, boPrintConsole);
+    vSetString(nEep_acTimeZone, pNewTimeZone, boPrintConsole);
+    vSetString(nEep_acNtpServer1, newNtpServer1, boPrintConsole);
+    vSetString(nEep_acNtpServer2, newNtpServer2, boPrintConsole);
     pNtpTime->vInit(
         acTimeZone,        // TimeZone see: https://github.com/nayarsystems/posix_tz_db/blob/master/zones.csv
         acNtpServer1,      // NTP server 1 e.g. "ptbtime1.ptb.de"
@@ -542,35 +430,55 @@ void Eep::vSetNtp(char *pNewTimeZoneName, char *pNewTimeZone, char *newNtpServer
 }
 //=======================================================================
 void Eep::vSetSwitchStatus(uint8_t u8NewSwitchStatus, bool boPrintConsole) {
-    uint8_t u8SwitchStatus_Tmp = 0;
-    bool boUpdated              = false;
-    u8SwitchStatus = u8NewSwitchStatus;
-    EEPROM.get(EepAdr_u8SwitchStatus, u8SwitchStatus_Tmp);
-    if (u8SwitchStatus_Tmp != u8SwitchStatus) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8SwitchStatus, u8SwitchStatus);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8SwitchStatus = 0x%02X ", EepAdr_u8SwitchStatus, boUpdated ? "updated" : "unchanged", u8SwitchStatus); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8SwitchStatus, u8NewSwitchStatus, boPrintConsole);
 }
 //=======================================================================
 void Eep::vSetPowerOnRestoreSwitch(uint8_t u8NewPowerOnRestoreSwitch, bool boPrintConsole) {
-    uint8_t u8PowerOnRestoreSwitch_Tmp = 0;
-    bool boUpdated                     = false;
-    u8PowerOnRestoreSwitch = u8NewPowerOnRestoreSwitch;
-    EEPROM.get(EepAdr_u8PowerOnRestoreSwitch, u8PowerOnRestoreSwitch_Tmp);
-    if (u8PowerOnRestoreSwitch_Tmp != u8PowerOnRestoreSwitch) {
-        // at least one value changed
-        EEPROM.put(EepAdr_u8PowerOnRestoreSwitch, u8PowerOnRestoreSwitch);
-        EEPROM.commit();
-        boUpdated = true;
-    }
-    if (u8DebugLevel & DEBUG_EEP_EVENTS && boPrintConsole) {
-        char buffer[100];
-        sprintf(buffer, "Eep.Write Adr:0x%04X %s u8PowerOnRestoreSwitch = 0x%02X ", EepAdr_u8PowerOnRestoreSwitch, boUpdated ? "updated" : "unchanged", u8PowerOnRestoreSwitch); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
-    }
+    vSetNumber(nEep_u8PowerOnRestoreSwitch, u8NewPowerOnRestoreSwitch, boPrintConsole);
+}
+
+//=======================================================================
+void Eep::vSetSegmentCount(uint8_t u8NewSegmentCount, bool boPrintConsole) {
+    vSetNumber(nEep_u8SegmentCount, u8NewSegmentCount, boPrintConsole);
+}
+
+//=======================================================================
+void Eep::vSetSegment(uint8_t u8Idx, const tSegment &stNewSegment, bool boPrintConsole) {
+    if (u8Idx >= SegmentsMax) return;
+    vStore(nEep_astSegments, u8Idx * sizeof(tSegment), &stNewSegment, sizeof(tSegment), boPrintConsole);
+}
+
+//=======================================================================
+void Eep::vSetMatrix(uint8_t u8NewWidth, uint8_t u8NewHeight, uint8_t u8NewLayout, bool boPrintConsole) {
+    if (!u8NewWidth || !u8NewHeight || (u8NewLayout >= nNoLayout)) {
+        // linear stripe
+        u8NewWidth  = 0;
+        u8NewHeight = 0;
+        u8NewLayout = nRowMajor;
+    }
+    vSetNumber(nEep_u8MatrixWidth, u8NewWidth, boPrintConsole);
+    vSetNumber(nEep_u8MatrixHeight, u8NewHeight, boPrintConsole);
+    vSetNumber(nEep_u8MatrixLayout, u8NewLayout, boPrintConsole);
+}
+
+//=======================================================================
+void Eep::vSetPalette(uint8_t u8NewPalette, bool boPrintConsole) {
+    vSetNumber(nEep_u8Palette, (u8NewPalette >= nNoPalette) ? (uint8_t)nPaletteRainbow : u8NewPalette, boPrintConsole);
+}
+
+//=======================================================================
+void Eep::vSetPowerBudget(uint16_t u16NewPowerBudget, bool boPrintConsole) {
+    vSetNumber(nEep_u16PowerBudget, (u16NewPowerBudget == 0xffff) ? 0 : u16NewPowerBudget, boPrintConsole);
+}
+
+//=======================================================================
+void Eep::vSetFrameRate(uint8_t u8NewFrameRate, bool boPrintConsole) {
+    vSetNumber(nEep_u8FrameRate, u8NewFrameRate, boPrintConsole);
+}
+
+//=======================================================================
+void Eep::vSetColorBalance(uint8_t u8NewRed, uint8_t u8NewGreen, uint8_t u8NewBlue, bool boPrintConsole) {
+    vSetNumber(nEep_u8BalanceRed, u8NewRed, boPrintConsole);
+    vSetNumber(nEep_u8BalanceGreen, u8NewGreen, boPrintConsole);
+    vSetNumber(nEep_u8BalanceBlue, u8NewBlue, boPrintConsole);
 }
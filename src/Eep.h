@@ -2,17 +2,124 @@
 #define Eep_h
 
 #include "NtpTime.h"
+#include "FlashLog.h"
+#include "Effects.h"
+#include "Palettes.h"
+#include "FrameTimer.h"
 #include <Arduino.h>
+#include <ArduinoJson.h> // see: https://arduinojson.org
 
 #define EepMotionOffDelayMin 4
 
 #define EepStringSize 50
 
-class Eep {
+#define EepSize        512  // size of the EEP image [byte]
+#define EepLogSectors  4    // flash sectors of the EEP log (FlashLog), the erases are spread over them
+#define EepCommitDelay 2000 // quiet time after the last change, before the changes are committed to the flash [ms]
+
+#define EepSegmentDefault  {0, 0, 0, 0, 0, 0, 0xff} // unused segment, full brightness
+#define EepSegmentsDefault {EepSegmentDefault, EepSegmentDefault, EepSegmentDefault, EepSegmentDefault, \
+                            EepSegmentDefault, EepSegmentDefault, EepSegmentDefault, EepSegmentDefault}
+
+// flags of an EEP value
+#define EepInternal 0x01 // not validated, not exported
+#define EepSecret   0x02 // not exported
+
+// EEP schema, one line per stored value in the order of the EEP layout. The
+// values are stored at their position in tEepData, don't reorder or resize
+// existing values (stored data), a new value is appended at the end:
+//   NUM(type, name, export key, default, min, max, flags)
+//   ARR(type, name, count, export key, default, flags)  (char: zero terminated string)
+// A value out of [min, max] is replaced by its default at the start (not
+// initialized) and clamped by vSetNumber/vSetDouble.
+#define EepFields(NUM, ARR) \
+    NUM(uint32_t, u32ChipId,               "chipId",         0,               0,    0,               EepInternal) \
+    NUM(uint16_t, u16LedCount,             "ledCount",       300,             0,    0xffff,          0) \
+    NUM(uint16_t, u16CalibrationValue,     "calibration",    200,             0,    0xffff,          0) \
+    NUM(uint16_t, u16Hue,                  "hue",            0,               0,    0xffff,          0) \
+    NUM(uint8_t,  u8Saturation,            "sat",            0,               0,    0xff,            0) \
+    NUM(uint8_t,  u8BrightnessDay,         "briDay",         128,             0,    0xff,            0) \
+    NUM(uint8_t,  u8DimMode,               "dimMode",        1,               0,    1,               0) \
+    ARR(char,     acWifiSsid,              EepStringSize,    "ssid",          "",                    0) \
+    ARR(char,     acWifiPwd,               EepStringSize,    "pwd",           "",                    EepSecret) \
+    NUM(uint8_t,  u8WiFiApMode,            "apMode",         1,               0,    1,               0) \
+    NUM(uint8_t,  u8BrightnessMin,         "briMin",         18,              0,    0xff,            0) \
+    NUM(uint8_t,  u8BrightnessMax,         "briMax",         0xff,            0,    0xff,            0) \
+    NUM(uint8_t,  u8ColorMode,             "colorMode",      nMonochrome,     0,    nNoMode - 1,     0) \
+    NUM(uint8_t,  u8Speed,                 "speed",          128,             0,    0xff,            0) \
+    NUM(uint8_t,  u8MotionOffDelay,        "motionOffDelay", 60 - EepMotionOffDelayMin, 0, 0xff,    0) \
+    NUM(uint8_t,  u8DistanceSensorEnabled, "distanceSensor", 0,               0,    0xff,            0) \
+    NUM(uint8_t,  u8MotionSensorEnabled,   "motionSensor",   1,               0,    0xff,            0) \
+    NUM(uint8_t,  u8BrightnessNight,       "briNight",       128,             0,    0xff,            0) \
+    NUM(double,   dLongitude,              "longitude",      0,               -180, 180,             0) \
+    NUM(double,   dLatitude,               "latitude",       0,               -90,  90,              0) \
+    ARR(char,     acTimeZone,              EepStringSize,    "timeZone",      "CET-1CEST,M3.5.0,M10.5.0/3", 0) \
+    ARR(char,     acNtpServer1,            EepStringSize,    "ntpServer1",    "ptbtime1.ptb.de",     0) \
+    ARR(char,     acNtpServer2,            EepStringSize,    "ntpServer2",    "ptbtime2.ptb.de",     0) \
+    ARR(char,     acTimeZoneName,          EepStringSize,    "timeZoneName",  "Europe/Berlin",       0) \
+    NUM(uint8_t,  u8SwitchStatus,          "switch",         0,               0,    1,               0) \
+    NUM(uint8_t,  u8PowerOnRestoreSwitch,  "restoreSwitch",  0,               0,    1,               0) \
+    NUM(uint8_t,  u8SegmentCount,          "segments",       0,               0,    SegmentsMax,     0) \
+    ARR(tSegment, astSegments,             SegmentsMax,      "segment",       EepSegmentsDefault,    0) \
+    NUM(uint8_t,  u8MatrixWidth,           "matrixWidth",    0,               0,    0xff,            0) \
+    NUM(uint8_t,  u8MatrixHeight,          "matrixHeight",   0,               0,    0xff,            0) \
+    NUM(uint8_t,  u8MatrixLayout,          "matrixLayout",   nRowMajor,       0,    nNoLayout - 1,   0) \
+    NUM(uint8_t,  u8Palette,               "palette",        nPaletteRainbow, 0,    nNoPalette - 1,  0) \
+    NUM(uint16_t, u16PowerBudget,          "power",          0,               0,    0xfffe,          0) \
+    NUM(uint8_t,  u8FrameRate,             "fps",            FrameTimerFpsDefault, 1, FrameTimerFpsMax, 0) \
+    NUM(uint8_t,  u8BalanceRed,            "balanceRed",     0xff,            1,    0xff,            0) \
+    NUM(uint8_t,  u8BalanceGreen,          "balanceGreen",   0xff,            1,    0xff,            0) \
+    NUM(uint8_t,  u8BalanceBlue,           "balanceBlue",    0xff,            1,    0xff,            0)
+
+#define EepFieldEnum(type, name, ...) nEep_##name,
+enum tEepFieldId {
+    EepFields(EepFieldEnum, EepFieldEnum)
+    nEepFields
+};
+
+#define EepNumMember(type, name, key, def, min, max, flags) type name;
+#define EepArrMember(type, name, count, key, def, flags)    type name[count];
+// all EEP values, the EEP image starts with them
+struct tEepData {
+    EepFields(EepNumMember, EepArrMember)
+} __attribute__((packed));
+
+enum tEepType {
+    nEepU8 = 0,
+    nEepU16,
+    nEepU32,
+    nEepDouble,
+    nEepString,
+    nEepSegments
+};
+
+// descriptor of one EEP value, generated from EepFields (astEepFields in PROGMEM)
+struct tEepField {
+    char     acName[24];    // member name (debug output)
+    char     acKey[16];     // key of the export
+    uint16_t u16Offset;     // position in tEepData and in the EEP image [byte]
+    uint16_t u16Size;       // [byte]
+    uint8_t  u8Type;        // tEepType
+    uint8_t  u8Flags;       // EepInternal, EepSecret
+    int32_t  i32Min;        // range of the numbers
+    int32_t  i32Max;
+};
+
+class Eep : public tEepData {
     public:
         Eep(uint8_t);
         void vInit(class NtpTime *);
         void vFactoryReset();
+        void vLoop();                                  // commit the changes, when they are EepCommitDelay old
+        void vFlush();                                 // commit the pending changes at once (before a restart)
+        uint32_t u32GetCommits();                      // flash commits since the start
+        uint32_t u32GetCommitsAvoided();               // changes merged into a pending commit
+        uint32_t u32GetErases();                       // flash sector erases since the start
+        void vSetNumber(uint8_t, int32_t, bool);       // store an integer value (tEepFieldId), clamped to its range
+        void vSetDouble(uint8_t, double, bool);        // store a double value (tEepFieldId), clamped to its range
+        void vSetString(uint8_t, const char *, bool);  // store a string (tEepFieldId), cut to its size
+        void vExport(JsonObject);                      // all values except the secret ones, for JSON and MsgPack
+        void vDump(const char *);                      // debug output of all values
         void vGetWifiSsid(char *);                     // read SSID
         void vGetWifiPwd(char *);                      // read PWD
         void vSetWifiSsidPwd(char *, char *, bool);    // update SSID and PWD
@@ -36,33 +143,25 @@ class Eep {
         void vSetNtp(char *, char *, char *, char *, bool); // store NTP TimeZone, NTP Server1, NTP Server2
         void vSetSwitchStatus(uint8_t, bool);               // store switch status
         void vSetPowerOnRestoreSwitch(uint8_t, bool);  // store mode for "restore switch status after PowerOnReset"
-
-        uint16_t u16LedCount;          // number of current configured LEDs (0..65535 default:300)
-        uint16_t u16CalibrationValue;      // distance sensor calibration value (0..65535 default:200)
-        uint16_t u16Hue;                   // color hue (0..65535 default:0)
-        uint8_t u8Saturation;              // color saturation value (0..65535 default:0)
-        uint8_t u8BrightnessDay;           // color brightness (0..255 default_128)
-        uint8_t u8BrightnessNight;         // color brightness (0..255 default_128)
-        uint8_t u8BrightnessMin;           // LED min brightness (0..255 default:24)
-        uint8_t u8BrightnessMax;           // LED max brightness (0..255 default:255)
-        uint8_t u8DimMode;                 // distancesensor dim mode (0:brightness ++/-- 1:brightness via distance default:1)
-        uint8_t u8WiFiApMode;              // wifi mode (0:SSID 1:AP default:1)
-        uint8_t u8ColorMode;               // color mode (0..2 default:0)
-        uint8_t u8Speed;                   // speed (0..255 default:128)
-        uint8_t u8MotionOffDelay;          // turn off delay [s] (1..255 default:60)
-        uint8_t u8DistanceSensorEnabled;   // enable/disable distance sensor (0..255 default:0)
-        uint8_t u8MotionSensorEnabled;     // enable/disable motion sensor (0..255 default:1)
-        uint8_t u8SwitchStatus;            // switch status (0..1 default:0)
-        uint8_t u8PowerOnRestoreSwitch;    // restore switch status after PowerOn (0..1 default:0)
-        char acTimeZone[EepStringSize];    // NTP Time Zone String
-        char acTimeZoneName[EepStringSize];// NTP Time Zone Name string
-        char acNtpServer1[EepStringSize];  // NTP server1
-        char acNtpServer2[EepStringSize];  // NTP server2
-        double dLongitude;                 // position Longitude
-        double dLatitude;                  // position Latitude
+        void vSetSegmentCount(uint8_t, bool);          // store number of segments (0:whole stripe with the global values)
+        void vSetSegment(uint8_t, const tSegment &, bool); // store one segment definition
+        void vSetMatrix(uint8_t, uint8_t, uint8_t, bool);  // store matrix width, height and layout (0,0: linear stripe)
+        void vSetPalette(uint8_t, bool);               // store palette of the palette effects (tPalette default:0)
+        void vSetPowerBudget(uint16_t, bool);          // store max. current of the stripe [mA] (0:unlimited default:0)
+        void vSetFrameRate(uint8_t, bool);             // store target frame rate [1/s] (1..FrameTimerFpsMax default:50)
+        void vSetColorBalance(uint8_t, uint8_t, uint8_t, bool); // store R,G,B correction (1..255 default:255:none)
 
     private:
+        void vStore(uint8_t, uint16_t, const void *, uint16_t, bool);
+        void vPrintField(uint8_t, const char *);
+        void vMarkDirty();
         uint8_t u8DebugLevel = 0;
         class NtpTime *pNtpTime;
+        FlashLog cFlashLog;
+        bool     boLog             = false; // the EEP image is stored in cFlashLog, false: in the EEPROM sector
+        bool     boDirty           = false; // EEP image has uncommitted changes
+        unsigned long ulDirtyTime  = 0;     // time of the last change [ms]
+        uint32_t u32Commits        = 0;
+        uint32_t u32CommitsAvoided = 0;
         };
 #endif
@@ -0,0 +1,315 @@
+#include "Effects.h"
+#include "ColorUtils.h"
+#include "Palettes.h"
+#include "Random.h"
+#include "Animation.h"
+
+const RgbColor rgbOff = RgbColor(0);
+
+const tEffect astEffects[nNoMode] = {
+    {"Monochrome",  NULL,             vRenderMonochrome},
+    {"Rainbow",     vInitRainbow,     vRenderRainbow},
+    {"Random",      vInitRandom,      vRenderRandom},
+    {"MovingPoint", vInitMovingPoint, vRenderMovingPoint},
+    {"Rainbow2D",   NULL,             vRenderRainbow2D},
+    {"MovingPoint2D", vInitMovingPoint2D, vRenderMovingPoint2D},
+    {"Palette",     vInitRainbow,     vRenderPalette},
+    {"Animation",   vInitAnimation,   vRenderAnimation}
+};
+
+//=============================================================================
+// LED of the matrix position, the layout is resolved by the precalculated map
+static inline uint16_t u16MatrixLed(const tEffectParams &stParams, uint16_t u16X, uint16_t u16Y) {
+    uint16_t u16Idx = u16Y * stParams.u16Width + u16X;
+    return stParams.pu16Map ? stParams.pu16Map[u16Idx] : u16Idx;
+}
+
+//=============================================================================
+// one step of a point, which moves forth and back between 0 and u16Size - 1
+static void vBounce(uint16_t &u16Pos, bool &boDirection, uint16_t u16Size) {
+    if (boDirection) {
+        if (++u16Pos >= u16Size) {
+            u16Pos = (u16Size > 1) ? (u16Size - 2) : 0;
+            boDirection = !boDirection;
+        }
+    } else {
+        if (u16Pos > 0) {
+            --u16Pos;
+        } else {
+            if (u16Size > 1) ++u16Pos;
+            boDirection = !boDirection;
+        }
+    }
+}
+
+//=============================================================================
+// use the same color of all pixels, but shift the color smoothly
+void vRenderMonochrome(
+    tNeoStripe *pFrame,
+    unsigned long ulMillis,
+    tEffectParams &stParams,
+    void *pState)
+{
+    stParams.u16Hue += stParams.u16HueStep;
+
+    // the color is converted once per frame, per pixel it's only the dither
+    Rgb48Color rgbLinearColor = stParams.pGammaLut->rgbLinear(rgbHsbToRgb(stParams.u16Hue, stParams.u8Saturation, stParams.u8Value));
+    for (uint16_t u16LedIdx = 0; u16LedIdx < stParams.u16LedCount; u16LedIdx++) {
+        // loop over all pixels
+        RgbColor rgbColor = stParams.pGammaLut->rgbDither(rgbLinearColor, stParams.u16FirstLed + u16LedIdx);
+        pFrame->SetPixelColor(stParams.u16FirstLed + u16LedIdx, rgbColor); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
+        stParams.u32ChannelSum += u16ChannelSum(rgbColor);
+    }
+}
+
+//=============================================================================
+// Precalculate the hue offset of each pixel for the rainbow (one 32bit division
+// per pixel is expensive on the ESP8266). The table needs 2 byte per LED in the
+// per LED state, without a table the offsets are calculated on the fly.
+void vInitRainbow(tEffectParams &stParams, void *pState) {
+    uint16_t *pu16RainbowHue = (uint16_t *)stParams.pu8PixelState;
+    if (!pu16RainbowHue) return;
+
+    for (uint16_t u16LedIdx = 0; u16LedIdx < stParams.u16LedCount; u16LedIdx++) {
+        pu16RainbowHue[u16LedIdx] = (uint16_t)(u16LedIdx * 65536L / stParams.u16LedCount);
+    }
+}
+
+//=============================================================================
+// draw a rainbow and shift/move the colors
+void vRenderRainbow(
+    tNeoStripe *pFrame,
+    unsigned long ulMillis,
+    tEffectParams &stParams,
+    void *pState)
+{
+    const uint16_t *pu16RainbowHue = (const uint16_t *)stParams.pu8PixelState;
+
+    stParams.u16Hue += stParams.u16HueStep;
+
+    for (uint16_t u16LedIdx = 0; u16LedIdx < stParams.u16LedCount; u16LedIdx++) {
+        // loop over all pixels
+        uint16_t u16PixelHue = stParams.u16Hue + (pu16RainbowHue ? pu16RainbowHue[u16LedIdx] : (u16LedIdx * 65536L / stParams.u16LedCount));
+        RgbColor rgbColor = stParams.pGammaLut->rgbCorrect(rgbHsbToRgb(u16PixelHue, stParams.u8Saturation, stParams.u8Value), stParams.u16FirstLed + u16LedIdx);
+        pFrame->SetPixelColor(stParams.u16FirstLed + u16LedIdx, rgbColor); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
+        stParams.u32ChannelSum += u16ChannelSum(rgbColor);
+    }
+}
+
+//=============================================================================
+// new random hue for each pixel
+void vInitRandom(tEffectParams &stParams, void *pState) {
+    tRandomPixel *pstPixel = (tRandomPixel *)stParams.pu8PixelState;
+    if (!pstPixel) return;
+
+    for (uint16_t u16LedIdx = 0; u16LedIdx < stParams.u16LedCount; u16LedIdx++) {
+        pstPixel[u16LedIdx].u16Hue    = u16Random();
+        pstPixel[u16LedIdx].u16Target = u16Random();
+    }
+}
+
+//=============================================================================
+// each pixel drifts smoothly to its own random target hue (first order lag,
+// time constant (256 - u8Speed) * EffectRandomTauPerSpeed), on arrival it
+// picks the next target. The filter factor is calculated once per frame, per
+// pixel it's one multiplication on the shorter way around the hue circle.
+void vRenderRandom(
+    tNeoStripe *pFrame,
+    unsigned long ulMillis,
+    tEffectParams &stParams,
+    void *pState)
+{
+    tRandomPixel *pstPixel = (tRandomPixel *)stParams.pu8PixelState;
+    if (!pstPixel) {
+        // without per LED state the whole segment drifts through the hues
+        vRenderMonochrome(pFrame, ulMillis, stParams, pState);
+        return;
+    }
+    // factor of the discrete lag dt / (tau + dt), stable for long frames too [1/65536]
+    uint32_t u32Tau   = (uint32_t)(256 - stParams.u8Speed) * EffectRandomTauPerSpeed;
+    int32_t  i32Alpha = stParams.u8Speed ? (int32_t)(((uint32_t)stParams.u16DeltaMs << 16) / (u32Tau + stParams.u16DeltaMs)) : 0;
+
+    for (uint16_t u16LedIdx = 0; u16LedIdx < stParams.u16LedCount; u16LedIdx++) {
+        tRandomPixel &stPixel = pstPixel[u16LedIdx];
+        if (i32Alpha) {
+            int16_t i16Diff = (int16_t)(stPixel.u16Target - stPixel.u16Hue); // shorter way, -180..+180 degree
+            int16_t i16Step = (int16_t)(((int32_t)i16Diff * i32Alpha) >> 16);
+            if (!i16Step && i16Diff) i16Step = (i16Diff > 0) ? 1 : -1; // the lag alone would never arrive
+            stPixel.u16Hue += i16Step;
+            if ((uint16_t)(abs(i16Diff - i16Step)) <= EffectRandomArrival) stPixel.u16Target = u16Random();
+        }
+        RgbColor rgbColor = stParams.pGammaLut->rgbCorrect(rgbHsbToRgb(stPixel.u16Hue, stParams.u8Saturation, stParams.u8Value), stParams.u16FirstLed + u16LedIdx);
+        pFrame->SetPixelColor(stParams.u16FirstLed + u16LedIdx, rgbColor); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
+        stParams.u32ChannelSum += u16ChannelSum(rgbColor);
+    }
+}
+
+//=============================================================================
+void vInitMovingPoint(tEffectParams &stParams, void *pState) {
+    tMovingPointState *pstPoint = (tMovingPointState *)pState;
+    if (pstPoint->u16Pos >= stParams.u16LedCount) {
+        pstPoint->u16Pos      = 0;
+        pstPoint->boDirection = false;
+    }
+}
+
+//=============================================================================
+// a single point moves forth and back, one step every (256 - speed) * 2ms,
+// several steps per frame at high speeds
+void vRenderMovingPoint(
+    tNeoStripe *pFrame,
+    unsigned long ulMillis,
+    tEffectParams &stParams,
+    void *pState)
+{
+    tMovingPointState *pstPoint = (tMovingPointState *)pState;
+    uint16_t u16StepPeriod = (uint16_t)(256 - stParams.u8Speed) << 1; // [ms]
+    uint16_t u16Steps      = 0;
+
+    if (stParams.u8Speed) {
+        pstPoint->u16StepTime += stParams.u16DeltaMs;
+        u16Steps = pstPoint->u16StepTime / u16StepPeriod;
+        pstPoint->u16StepTime -= u16Steps * u16StepPeriod;
+    }
+    while (u16Steps--) {
+        vBounce(pstPoint->u16Pos, pstPoint->boDirection, stParams.u16LedCount);
+    }
+
+    // the point is the only lit pixel, only its color is converted
+    pFrame->ClearTo(rgbOff, stParams.u16FirstLed, stParams.u16FirstLed + stParams.u16LedCount - 1); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-cleartocolorobject-color-uint16_t-first-uint16_t-last
+    if (pstPoint->u16Pos < stParams.u16LedCount) {
+        uint16_t u16Led   = stParams.u16FirstLed + pstPoint->u16Pos;
+        RgbColor rgbColor = stParams.pGammaLut->rgbCorrect(rgbHsbToRgb(stParams.u16Hue, stParams.u8Saturation, stParams.u8Value), u16Led);
+        pFrame->SetPixelColor(u16Led, rgbColor); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
+        stParams.u32ChannelSum += u16ChannelSum(rgbColor);
+    }
+}
+
+//=============================================================================
+// diagonal rainbow over the matrix, the hue changes by the same step per
+// column and per row
+void vRenderRainbow2D(
+    tNeoStripe *pFrame,
+    unsigned long ulMillis,
+    tEffectParams &stParams,
+    void *pState)
+{
+    uint16_t u16HueStep = (uint16_t)(65536L / (stParams.u16Width + stParams.u16Height));
+
+    stParams.u16Hue += stParams.u16HueStep;
+
+    uint16_t u16RowHue = stParams.u16Hue;
+    for (uint16_t u16Y = 0; u16Y < stParams.u16Height; u16Y++) {
+        uint16_t u16PixelHue = u16RowHue;
+        for (uint16_t u16X = 0; u16X < stParams.u16Width; u16X++) {
+            uint16_t u16LedIdx = u16MatrixLed(stParams, u16X, u16Y);
+            RgbColor rgbColor  = stParams.pGammaLut->rgbCorrect(rgbHsbToRgb(u16PixelHue, stParams.u8Saturation, stParams.u8Value), stParams.u16FirstLed + u16LedIdx);
+            pFrame->SetPixelColor(stParams.u16FirstLed + u16LedIdx, rgbColor); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
+            stParams.u32ChannelSum += u16ChannelSum(rgbColor);
+            u16PixelHue += u16HueStep;
+        }
+        u16RowHue += u16HueStep;
+    }
+    uint16_t u16MatrixLeds = stParams.u16Width * stParams.u16Height;
+    if (u16MatrixLeds < stParams.u16LedCount) {
+        // LEDs behind the matrix
+        pFrame->ClearTo(rgbOff, stParams.u16FirstLed + u16MatrixLeds, stParams.u16FirstLed + stParams.u16LedCount - 1);
+    }
+}
+
+//=============================================================================
+void vInitMovingPoint2D(tEffectParams &stParams, void *pState) {
+    tMovingPoint2DState *pstPoint = (tMovingPoint2DState *)pState;
+    if ((pstPoint->u16X >= stParams.u16Width) || (pstPoint->u16Y >= stParams.u16Height)) {
+        pstPoint->u16X = 0;
+        pstPoint->u16Y = 0;
+    }
+    pstPoint->boDirectionX = true;
+    pstPoint->boDirectionY = true;
+}
+
+//=============================================================================
+// a point bounces diagonally between the edges of the matrix, one step every
+// (256 - speed) * 2ms like the linear moving point
+void vRenderMovingPoint2D(
+    tNeoStripe *pFrame,
+    unsigned long ulMillis,
+    tEffectParams &stParams,
+    void *pState)
+{
+    tMovingPoint2DState *pstPoint = (tMovingPoint2DState *)pState;
+    uint16_t u16StepPeriod = (uint16_t)(256 - stParams.u8Speed) << 1; // [ms]
+    uint16_t u16Steps      = 0;
+
+    if (stParams.u8Speed) {
+        pstPoint->u16StepTime += stParams.u16DeltaMs;
+        u16Steps = pstPoint->u16StepTime / u16StepPeriod;
+        pstPoint->u16StepTime -= u16Steps * u16StepPeriod;
+    }
+    while (u16Steps--) {
+        vBounce(pstPoint->u16X, pstPoint->boDirectionX, stParams.u16Width);
+        vBounce(pstPoint->u16Y, pstPoint->boDirectionY, stParams.u16Height);
+    }
+
+    uint16_t u16Led   = stParams.u16FirstLed + u16MatrixLed(stParams, pstPoint->u16X, pstPoint->u16Y);
+    RgbColor rgbColor = stParams.pGammaLut->rgbCorrect(rgbHsbToRgb(stParams.u16Hue, stParams.u8Saturation, stParams.u8Value), u16Led);
+    pFrame->ClearTo(rgbOff, stParams.u16FirstLed, stParams.u16FirstLed + stParams.u16LedCount - 1); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-cleartocolorobject-color-uint16_t-first-uint16_t-last
+    pFrame->SetPixelColor(u16Led, rgbColor);
+    stParams.u32ChannelSum += u16ChannelSum(rgbColor);
+}
+
+//=============================================================================
+// the palette stretched over the segment and shifted like the rainbow, uses
+// the rainbow offset table, per pixel one lerp instead of the HSB conversion
+void vRenderPalette(
+    tNeoStripe *pFrame,
+    unsigned long ulMillis,
+    tEffectParams &stParams,
+    void *pState)
+{
+    const uint16_t *pu16Offset = (const uint16_t *)stParams.pu8PixelState;
+
+    stParams.u16Hue += stParams.u16HueStep;
+
+    for (uint16_t u16LedIdx = 0; u16LedIdx < stParams.u16LedCount; u16LedIdx++) {
+        // loop over all pixels
+        uint16_t u16Pos = stParams.u16Hue + (pu16Offset ? pu16Offset[u16LedIdx] : (u16LedIdx * 65536L / stParams.u16LedCount));
+        RgbColor rgbColor = stParams.pGammaLut->rgbCorrect(rgbPaletteColor(stParams.pPalette, u16Pos, stParams.u8Value), stParams.u16FirstLed + u16LedIdx);
+        pFrame->SetPixelColor(stParams.u16FirstLed + u16LedIdx, rgbColor); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
+        stParams.u32ChannelSum += u16ChannelSum(rgbColor);
+    }
+}
+
+//=============================================================================
+void vInitAnimation(tEffectParams &stParams, void *pState) {
+    if (!stParams.pAnimation->boIsOpen()) stParams.pAnimation->boOpen();
+}
+
+//=============================================================================
+// show the current frame of the streamed animation, LEDs without animation
+// data are off
+void vRenderAnimation(
+    tNeoStripe *pFrame,
+    unsigned long ulMillis,
+    tEffectParams &stParams,
+    void *pState)
+{
+    const uint8_t *pu8Rgb = stParams.pAnimation->pu8GetFrame(ulMillis, stParams.u16DeltaMs);
+    uint16_t u16Leds      = pu8Rgb ? stParams.pAnimation->u16GetLedCount() : 0;
+    uint16_t u16Scale     = (uint16_t)stParams.u8Value + 1;
+
+    if (u16Leds > stParams.u16LedCount) u16Leds = stParams.u16LedCount;
+    for (uint16_t u16LedIdx = 0; u16LedIdx < u16Leds; u16LedIdx++) {
+        RgbColor rgbColor = stParams.pGammaLut->rgbCorrect(RgbColor(
+                      (uint8_t)((pu8Rgb[0] * u16Scale) >> 8),
+                      (uint8_t)((pu8Rgb[1] * u16Scale) >> 8),
+                      (uint8_t)((pu8Rgb[2] * u16Scale) >> 8)),
+                  stParams.u16FirstLed + u16LedIdx);
+        pu8Rgb += 3;
+        pFrame->SetPixelColor(stParams.u16FirstLed + u16LedIdx, rgbColor); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
+        stParams.u32ChannelSum += u16ChannelSum(rgbColor);
+    }
+    if (u16Leds < stParams.u16LedCount) {
+        pFrame->ClearTo(rgbOff, stParams.u16FirstLed + u16Leds, stParams.u16FirstLed + stParams.u16LedCount - 1); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-cleartocolorobject-color-uint16_t-first-uint16_t-last
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef Effects_h
+#define Effects_h
+#include "GammaLut.h"
+#include <Arduino.h>
+#include <NeoPixelBus.h> // see: https://github.com/Makuna/NeoPixelBus
+
+#define EffectHueRatePerSpeed   50     // hue shift per speed step [1/s], speed 255: ~12750/s (one turn in ~5s)
+#define EffectMaxDeltaMs        100    // max. animation time per frame, longer loop stalls don't make the effects jump [ms]
+#define EffectRandomTauPerSpeed 16     // time constant of the random hue drift per speed step below 256 [ms], speed 255: 16ms, 1: ~4s
+#define EffectRandomArrival     0x0100 // hue distance, at which a pixel of the random effect picks its next target
+
+typedef NeoPixelBus<NeoGrbFeature, Neo800KbpsMethod> tNeoStripe;
+
+enum tColorMode {
+    nMonochrome = 0,
+    nRainbow,
+    nRandom,
+    nMovingPoint,
+    nRainbow2D,
+    nMovingPoint2D,
+    nPalette,
+    nAnimation,
+    nNoMode
+};
+
+// LED order of a matrix, see: https://github.com/Makuna/NeoPixelBus/wiki/Layout-objects
+enum tMatrixLayout {
+    nRowMajor = 0,            // rows, all from left to right
+    nRowMajorAlternating,     // rows, serpentine
+    nColumnMajor,             // columns, all from top to bottom
+    nColumnMajorAlternating,  // columns, serpentine
+    nNoLayout
+};
+
+#define SegmentsMax 8 // max. number of stripe segments
+
+// one part of the stripe with its own effect, 10 byte in the EEP
+struct tSegment {
+    uint16_t u16Start;      // first LED
+    uint16_t u16Count;      // number of LEDs
+    uint16_t u16Hue;        // color hue (0..65535)
+    uint8_t  u8ColorMode;   // color mode (tColorMode)
+    uint8_t  u8Saturation;  // color saturation (0..255)
+    uint8_t  u8Speed;       // speed (0..255)
+    uint8_t  u8Brightness;  // brightness relative to the stripe brightness (0..255)
+} __attribute__((packed));
+
+// values of one effect call, the shared part is calculated once per frame by LedStripe
+struct tEffectParams {
+    uint16_t u16FirstLed;          // first pixel of the segment
+    uint16_t u16LedCount;          // pixels of the segment
+    uint16_t u16Hue;               // in: configured hue, out: shifted hue (stored by LedStripe)
+    uint8_t  u8Saturation;
+    uint8_t  u8Value;              // HSB brightness of the segment (0xff: stripe brightness)
+    uint8_t  u8Speed;
+    uint16_t u16DeltaMs;           // animation time since the last frame (max. EffectMaxDeltaMs) [ms]
+    uint16_t u16HueStep;           // hue shift of this frame, u8Speed as rate of EffectHueRatePerSpeed
+    GammaLut *pGammaLut;           // brightness, color balance, gamma and dither of this frame
+    uint8_t  *pu8PixelState;       // per LED state of the segment (u16LedCount * LedStateBytesPerLed), NULL: none
+    uint16_t u16Width;             // matrix width, u16LedCount without matrix
+    uint16_t u16Height;            // matrix height, 1 without matrix
+    const uint16_t *pu16Map;       // matrix index (y * width + x) -> LED index of the segment, NULL: linear
+    const RgbColor *pPalette;      // expanded palette (PaletteSize entries) of the palette effects
+    uint32_t u32ChannelSum;        // out: sum of all written R+G+B values of the frame (power estimation)
+    class Animation *pAnimation;   // player of the uploaded animation
+};
+
+// one entry of the effect registry, looked up by tColorMode
+struct tEffect {
+    const char *pcName;
+    void (*vInit)(tEffectParams &, void *);                          // effect becomes active, NULL: nothing to do
+    void (*vRender)(tNeoStripe *, unsigned long, tEffectParams &, void *); // frame buffer, millis(), params, state
+};
+
+struct tMovingPointState {
+    uint16_t u16Pos;
+    bool     boDirection;
+    uint16_t u16StepTime;          // animation time since the last step [ms]
+};
+
+struct tMovingPoint2DState {
+    uint16_t u16X;
+    uint16_t u16Y;
+    bool     boDirectionX;
+    bool     boDirectionY;
+    uint16_t u16StepTime;          // animation time since the last step [ms]
+};
+
+// per LED state of the random effect, 4 byte
+struct tRandomPixel {
+    uint16_t u16Hue;               // current hue
+    uint16_t u16Target;            // hue, the pixel drifts to
+};
+
+// effect state of one segment, the per LED state is in tEffectParams
+union tEffectState {
+    tMovingPointState   stMovingPoint;
+    tMovingPoint2DState stMovingPoint2D;
+};
+
+extern const tEffect astEffects[nNoMode]; // effect registry, index: tColorMode
+
+// R+G+B of a stripe color, the LED current is proportional to it
+inline uint16_t u16ChannelSum(const RgbColor &rgbColor) {
+    return (uint16_t)rgbColor.R + rgbColor.G + rgbColor.B;
+}
+
+void vRenderMonochrome(tNeoStripe *, unsigned long, tEffectParams &, void *);
+void vInitRainbow(tEffectParams &, void *);
+void vRenderRainbow(tNeoStripe *, unsigned long, tEffectParams &, void *);
+void vInitRandom(tEffectParams &, void *);
+void vRenderRandom(tNeoStripe *, unsigned long, tEffectParams &, void *);
+void vInitMovingPoint(tEffectParams &, void *);
+void vRenderMovingPoint(tNeoStripe *, unsigned long, tEffectParams &, void *);
+void vRenderRainbow2D(tNeoStripe *, unsigned long, tEffectParams &, void *);
+void vInitMovingPoint2D(tEffectParams &, void *);
+void vRenderMovingPoint2D(tNeoStripe *, unsigned long, tEffectParams &, void *);
+void vRenderPalette(tNeoStripe *, unsigned long, tEffectParams &, void *);
+void vInitAnimation(tEffectParams &, void *);
+void vRenderAnimation(tNeoStripe *, unsigned long, tEffectParams &, void *);
+
+#endif
@@ -0,0 +1,252 @@
+#include "FlashLog.h"
+#include "Utils.h"
+#include "DebugLevel.h"
+
+#define CLASS_NAME "FlashLog"
+
+#define FlashLogPad(len) (((len) + 3) & ~3) // flash writes are 4 byte aligned
+
+//=======================================================================
+FlashLog::FlashLog(uint8_t u8NewDebugLevel) {
+    u8DebugLevel = u8NewDebugLevel;
+}
+
+//=======================================================================
+// replay the newest valid sector into the image, try the older ones, when
+// its snapshot is broken
+bool FlashLog::boInit(uint32_t u32NewFirstSector, uint8_t u8NewSectors, uint8_t *pu8NewImage, uint16_t u16NewImageSize) {
+    u32FirstSector = u32NewFirstSector;
+    u8Sectors      = (u8NewSectors > FlashLogSectorsMax) ? FlashLogSectorsMax : u8NewSectors;
+    pu8Image       = pu8NewImage;
+    u16ImageSize   = u16NewImageSize;
+    if (pu8Logged == NULL) {
+        pu8Logged = new uint8_t[u16ImageSize];
+    }
+    boValid            = false;
+    u32Sequence        = 0;
+    u16ReplayedRecords = 0;
+    u32ReplayedBytes   = 0;
+
+    uint32_t au32Sequence[FlashLogSectorsMax];
+    for (uint8_t u8Sector = 0; u8Sector < u8Sectors; u8Sector++) {
+        tFlashLogSector stHeader;
+        ESP.flashRead(u32SectorAdr(u8Sector), (uint32_t *)&stHeader, sizeof(stHeader));
+        u32ReplayedBytes += sizeof(stHeader);
+        au32Sequence[u8Sector] = (stHeader.u32Magic == FlashLogMagic) ? stHeader.u32Sequence : 0;
+        if (au32Sequence[u8Sector] > u32Sequence) {
+            u32Sequence = au32Sequence[u8Sector]; // a new compaction must be newer than all sectors
+        }
+    }
+
+    uint32_t u32Tried = 0xffffffff;
+    while (!boValid) {
+        // newest sector, which wasn't tried yet
+        uint32_t u32Best = 0;
+        uint8_t  u8Best  = 0;
+        for (uint8_t u8Sector = 0; u8Sector < u8Sectors; u8Sector++) {
+            if ((au32Sequence[u8Sector] > u32Best) && (au32Sequence[u8Sector] < u32Tried)) {
+                u32Best = au32Sequence[u8Sector];
+                u8Best  = u8Sector;
+            }
+        }
+        if (!u32Best) break; // no valid sector left
+        u32Tried = u32Best;
+        boValid  = boReplay(u8Best);
+    }
+
+    if (u8DebugLevel & DEBUG_EEP_EVENTS) {
+        char buffer[100];
+        sprintf(buffer, "FlashLog.Replay %s sector:%d records:%d read:%lubyte ", boValid ? "valid" : "empty", u8Current, u16ReplayedRecords, (unsigned long)u32ReplayedBytes); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+    }
+    return boValid;
+}
+
+//=======================================================================
+// snapshot and records of one sector; the records are read into pu8Logged and
+// only copied into the image, when their CRC is valid
+bool FlashLog::boReplay(uint8_t u8Sector) {
+    uint32_t u32Adr = u32SectorAdr(u8Sector);
+    uint16_t u16Pos = FlashLogHeaderSize;
+    uint16_t u16Records = 0;
+    uint32_t au32Chunk[FlashLogChunkWords];
+
+    while (u16Pos + FlashLogRecordFrame <= FlashLogSectorSize) {
+        tFlashLogRecord stRecord;
+        uint32_t u32Word = 0;
+        ESP.flashRead(u32Adr + u16Pos, &u32Word, sizeof(u32Word));
+        memcpy(&stRecord, &u32Word, sizeof(stRecord));
+        u32ReplayedBytes += sizeof(stRecord);
+        if ((stRecord.u16Offset == 0xffff) && (stRecord.u16Length == 0xffff)) {
+            break; // free flash, end of the log
+        }
+        uint16_t u16Size = FlashLogRecordFrame + FlashLogPad(stRecord.u16Length);
+        if (   !stRecord.u16Length
+            || ((uint32_t)stRecord.u16Offset + stRecord.u16Length > u16ImageSize)
+            || ((uint32_t)u16Pos + u16Size > FlashLogSectorSize)
+            || (!u16Records && (stRecord.u16Length != u16ImageSize))) {
+            u16Pos = FlashLogSectorSize; // broken header, the next write compacts
+            break;
+        }
+
+        uint32_t u32Check = u32Crc(0, (const uint8_t *)&stRecord, sizeof(stRecord));
+        for (uint16_t u16Done = 0; u16Done < stRecord.u16Length; u16Done += sizeof(au32Chunk)) {
+            uint16_t u16Chunk = stRecord.u16Length - u16Done;
+            if (u16Chunk > sizeof(au32Chunk)) u16Chunk = sizeof(au32Chunk);
+            ESP.flashRead(u32Adr + u16Pos + sizeof(stRecord) + u16Done, au32Chunk, FlashLogPad(u16Chunk));
+            memcpy(pu8Logged + stRecord.u16Offset + u16Done, au32Chunk, u16Chunk);
+            u32Check = u32Crc(u32Check, (const uint8_t *)au32Chunk, u16Chunk);
+        }
+        uint32_t u32StoredCrc = 0;
+        ESP.flashRead(u32Adr + u16Pos + u16Size - sizeof(u32StoredCrc), &u32StoredCrc, sizeof(u32StoredCrc));
+        u32ReplayedBytes += FlashLogPad(stRecord.u16Length) + sizeof(u32StoredCrc);
+        if (u32StoredCrc != u32Check) {
+            // record not completely written (power loss)
+            if (!u16Records) return false;
+            memcpy(pu8Logged + stRecord.u16Offset, pu8Image + stRecord.u16Offset, stRecord.u16Length);
+            u16Pos = FlashLogSectorSize;
+            break;
+        }
+        memcpy(pu8Image + stRecord.u16Offset, pu8Logged + stRecord.u16Offset, stRecord.u16Length);
+        u16Records++;
+        u16Pos += u16Size;
+    }
+    if (!u16Records) return false;
+
+    u8Current          = u8Sector;
+    u16WritePos        = u16Pos;
+    u16ReplayedRecords = u16Records;
+    return true;
+}
+
+//=======================================================================
+// one record per changed range, ranges closer than FlashLogMergeGap are merged
+bool FlashLog::boWrite() {
+    if (!boValid) {
+        return boCompact();
+    }
+    uint16_t u16Pos = 0;
+    while (u16Pos < u16ImageSize) {
+        if (pu8Image[u16Pos] == pu8Logged[u16Pos]) {
+            u16Pos++;
+            continue;
+        }
+        uint16_t u16Start = u16Pos;
+        uint16_t u16End   = u16Pos + 1; // behind the last changed byte
+        for (uint16_t u16Next = u16End; (u16Next < u16ImageSize) && (u16Next < u16End + FlashLogMergeGap); u16Next++) {
+            if (pu8Image[u16Next] != pu8Logged[u16Next]) {
+                u16End = u16Next + 1;
+            }
+        }
+        if (!boAppend(u16Start, u16End - u16Start)) {
+            return false;
+        }
+        u16Pos = u16End;
+    }
+    return true;
+}
+
+//=======================================================================
+bool FlashLog::boAppend(uint16_t u16Offset, uint16_t u16Length) {
+    uint16_t u16Size = FlashLogRecordFrame + FlashLogPad(u16Length);
+    if (u16WritePos + u16Size > FlashLogSectorSize) {
+        return boCompact(); // the snapshot contains this and all further changes
+    }
+    if (!boWriteRecord(u32SectorAdr(u8Current) + u16WritePos, u16Offset, u16Length)) {
+        u16WritePos = FlashLogSectorSize; // don't append behind a broken record
+        return false;
+    }
+    memcpy(pu8Logged + u16Offset, pu8Image + u16Offset, u16Length);
+    u16WritePos += u16Size;
+    u32Records++;
+    return true;
+}
+
+//=======================================================================
+// snapshot of the image into the next sector of the ring, the current sector
+// stays valid until the header of the new one is written
+bool FlashLog::boCompact() {
+    uint8_t u8Next = boValid ? (u8Current + 1) % u8Sectors : 0;
+    uint32_t u32Adr = u32SectorAdr(u8Next);
+    if (!ESP.flashEraseSector(u32FirstSector + u8Next)) {
+        return false;
+    }
+    u32Erases++;
+    if (!boWriteRecord(u32Adr + FlashLogHeaderSize, 0, u16ImageSize)) {
+        return false;
+    }
+    tFlashLogSector stHeader = {FlashLogMagic, u32Sequence + 1};
+    if (!ESP.flashWrite(u32Adr, (uint32_t *)&stHeader, sizeof(stHeader))) {
+        return false;
+    }
+    u8Current   = u8Next;
+    u32Sequence = stHeader.u32Sequence;
+    u16WritePos = FlashLogHeaderSize + FlashLogRecordFrame + FlashLogPad(u16ImageSize);
+    boValid     = true;
+    memcpy(pu8Logged, pu8Image, u16ImageSize);
+    u32Records++;
+
+    if (u8DebugLevel & DEBUG_EEP_EVENTS) {
+        char buffer[100];
+        sprintf(buffer, "FlashLog.Compact sector:%d sequence:%lu erases:%lu ", u8Current, (unsigned long)u32Sequence, (unsigned long)u32Erases); vConsole(u8DebugLevel, DEBUG_EEP_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+    }
+    return true;
+}
+
+//=======================================================================
+// header, image range and CRC; the CRC is written last, a record without it
+// is ignored by the replay
+bool FlashLog::boWriteRecord(uint32_t u32Adr, uint16_t u16Offset, uint16_t u16Length) {
+    uint32_t au32Chunk[FlashLogChunkWords];
+    tFlashLogRecord stRecord = {u16Offset, u16Length};
+    uint32_t u32Check = u32Crc(0, (const uint8_t *)&stRecord, sizeof(stRecord));
+    u32Check = u32Crc(u32Check, pu8Image + u16Offset, u16Length);
+
+    memcpy(au32Chunk, &stRecord, sizeof(stRecord));
+    bool boOk = ESP.flashWrite(u32Adr, au32Chunk, sizeof(stRecord));
+    u32Adr += sizeof(stRecord);
+    for (uint16_t u16Done = 0; boOk && (u16Done < u16Length); u16Done += sizeof(au32Chunk)) {
+        uint16_t u16Chunk = u16Length - u16Done;
+        if (u16Chunk > sizeof(au32Chunk)) u16Chunk = sizeof(au32Chunk);
+        memset(au32Chunk, 0xff, sizeof(au32Chunk));
+        memcpy(au32Chunk, pu8Image + u16Offset + u16Done, u16Chunk);
+        boOk = ESP.flashWrite(u32Adr + u16Done, au32Chunk, FlashLogPad(u16Chunk));
+    }
+    return boOk && ESP.flashWrite(u32Adr + FlashLogPad(u16Length), &u32Check, sizeof(u32Check));
+}
+
+//=======================================================================
+uint32_t FlashLog::u32SectorAdr(uint8_t u8Sector) {
+    return (u32FirstSector + u8Sector) * FlashLogSectorSize;
+}
+
+//=======================================================================
+uint32_t FlashLog::u32Crc(uint32_t u32Crc, const uint8_t *pu8Data, uint16_t u16Length) {
+    u32Crc = ~u32Crc;
+    while (u16Length--) {
+        u32Crc ^= *pu8Data++;
+        for (uint8_t u8Bit = 0; u8Bit < 8; u8Bit++) {
+            u32Crc = (u32Crc >> 1) ^ (0xedb88320UL & (0 - (u32Crc & 1)));
+        }
+    }
+    return ~u32Crc;
+}
+
+//=======================================================================
+uint32_t FlashLog::u32GetErases() {
+    return u32Erases;
+}
+
+//=======================================================================
+uint32_t FlashLog::u32GetRecords() {
+    return u32Records;
+}
+
+//=======================================================================
+uint16_t FlashLog::u16GetReplayedRecords() {
+    return u16ReplayedRecords;
+}
+
+//=======================================================================
+uint32_t FlashLog::u32GetReplayedBytes() {
+    return u32ReplayedBytes;
+}
@@ -0,0 +1,66 @@
+#ifndef FlashLog_h
+#define FlashLog_h
+#include <Arduino.h>
+
+#define FlashLogSectorSize   4096       // erase unit of the SPI flash [byte]
+#define FlashLogSectorsMax   16         // max. sectors of the ring
+#define FlashLogMagic        0x474f4c57 // "WLOG", header of a valid log sector
+#define FlashLogHeaderSize   8          // tFlashLogSector [byte]
+#define FlashLogRecordFrame  8          // record header + CRC32 [byte]
+#define FlashLogMergeGap     8          // changed runs closer than this are written as one record [byte]
+#define FlashLogChunkWords   16         // flash read/write buffer on the stack [uint32_t]
+
+// first words of a log sector, written after its snapshot (commit marker)
+struct tFlashLogSector {
+    uint32_t u32Magic;
+    uint32_t u32Sequence; // incremented with every compaction, the highest valid one is the current sector
+};
+
+// first word of a record, followed by the data (padded to 4 byte) and the CRC32 of header and data
+struct tFlashLogRecord {
+    uint16_t u16Offset;   // position in the image [byte]
+    uint16_t u16Length;   // data length [byte], 0xffff: free flash, end of the sector
+};
+
+// Append-only log of a RAM image (the EEP values) over a ring of flash
+// sectors. A write appends one record per changed range of the image instead
+// of erasing a sector. When the current sector is full, the next one is erased
+// and starts with a snapshot of the whole image (compaction), so each sector
+// is complete on its own and the erases are spread over all sectors.
+// At the start the sector with the highest sequence is replayed until the
+// first free or broken record; a power loss while writing only loses the
+// record (or the compaction) being written.
+class FlashLog {
+    public:
+        FlashLog(uint8_t);
+        bool boInit(uint32_t, uint8_t, uint8_t *, uint16_t); // first sector, sectors (min. 2), image, image size; false: no valid log, image unchanged
+        bool boWrite();                   // append the changes of the image, false: flash error
+        uint32_t u32GetErases();          // sector erases since the start
+        uint32_t u32GetRecords();         // records written since the start
+        uint16_t u16GetReplayedRecords(); // records of the current sector read by boInit
+        uint32_t u32GetReplayedBytes();   // flash read by boInit [byte]
+        static uint32_t u32Crc(uint32_t, const uint8_t *, uint16_t); // CRC32 (IEEE), continue with the last value (0: start)
+
+    private:
+        bool boReplay(uint8_t);
+        bool boAppend(uint16_t, uint16_t);
+        bool boCompact();
+        bool boWriteRecord(uint32_t, uint16_t, uint16_t);
+        uint32_t u32SectorAdr(uint8_t);
+        uint8_t  u8DebugLevel         = 0;
+        uint32_t u32FirstSector       = 0;
+        uint8_t  u8Sectors            = 0;
+        uint8_t *pu8Image             = NULL;
+        uint8_t *pu8Logged            = NULL; // image content in the flash
+        uint16_t u16ImageSize         = 0;
+        bool     boValid              = false; // u8Current holds a valid sector
+        uint8_t  u8Current            = 0;     // sector, the records are appended to
+        uint32_t u32Sequence          = 0;     // sequence of u8Current
+        uint16_t u16WritePos          = 0;     // next record in u8Current [byte]
+        uint32_t u32Erases            = 0;
+        uint32_t u32Records           = 0;
+        uint16_t u16ReplayedRecords   = 0;
+        uint32_t u32ReplayedBytes     = 0;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "FrameTimer.h"
+
+//=======================================================================
+FrameTimer::FrameTimer(uint8_t u8NewFps) {
+    vSetFps(u8NewFps);
+}
+
+//=======================================================================
+void FrameTimer::vSetFps(uint8_t u8NewFps) {
+    u8TargetFps = u8NewFps ? u8NewFps : 1;
+    ulPeriod    = 1000000UL / u8TargetFps;
+    ulBudget    = ulPeriod / 2; // leave the other half of the frame to WiFi, MQTT, buttons...
+    ulNextFrame = micros();
+}
+
+//=======================================================================
+bool FrameTimer::boTick() {
+    unsigned long ulNow = micros();
+
+    if ((long)(ulNow - ulNextFrame) < 0)
+        return false; // frame not due yet
+
+    if (ulLastFrame) {
+        // deviation of the real frame interval from the target period
+        unsigned long ulInterval = ulNow - ulLastFrame;
+        unsigned long ulJitterUs = ulInterval > ulPeriod ? ulInterval - ulPeriod : ulPeriod - ulInterval;
+        if (ulJitterUs > ulWindowJitter) ulWindowJitter = ulJitterUs;
+    }
+    ulLastFrame  = ulNow;
+    ulFrameStart = ulNow;
+
+    ulNextFrame += ulPeriod;
+    if ((long)(ulNow - ulNextFrame) >= 0) {
+        // more than one frame late (e.g. blocking WiFi), don't try to catch up
+        ulNextFrame = ulNow + ulPeriod;
+    }
+
+    u16WindowFrames++;
+    if (ulNow - ulWindowStart >= 1000000UL) {
+        // publish the values of the last second
+        u16Fps          = u16WindowFrames;
+        ulJitter        = ulWindowJitter;
+        ulFrameTime     = ulWindowTime;
+        u16WindowFrames = 0;
+        ulWindowJitter  = 0;
+        ulWindowTime    = 0;
+        ulWindowStart   = ulNow;
+    }
+    return true;
+}
+
+//=======================================================================
+void FrameTimer::vFrameDone() {
+    unsigned long ulRenderTime = micros() - ulFrameStart;
+    if (ulRenderTime > ulWindowTime) ulWindowTime = ulRenderTime;
+    if (ulRenderTime > ulBudget) u32OverBudget++;
+}
+
+//=======================================================================
+uint8_t FrameTimer::u8GetTargetFps() {
+    return u8TargetFps;
+}
+
+//=======================================================================
+uint16_t FrameTimer::u16GetFps() {
+    return u16Fps;
+}
+
+//=======================================================================
+unsigned long FrameTimer::ulGetJitter() {
+    return ulJitter;
+}
+
+//=======================================================================
+unsigned long FrameTimer::ulGetFrameTime() {
+    return ulFrameTime;
+}
+
+//=======================================================================
+unsigned long FrameTimer::ulGetFrameBudget() {
+    return ulBudget;
+}
+
+//=======================================================================
+uint32_t FrameTimer::u32GetOverBudget() {
+    return u32OverBudget;
+}
@@ -0,0 +1,38 @@
+#ifndef FrameTimer_h
+#define FrameTimer_h
+#include <Arduino.h>
+
+#define FrameTimerFpsDefault 50  // default LED frame rate [1/s]
+#define FrameTimerFpsMax     100 // max. configurable LED frame rate [1/s]
+
+class FrameTimer {
+    public:
+        FrameTimer(uint8_t);
+        void vSetFps(uint8_t);                // change the target frame rate
+        bool boTick();                        // true, when the next frame is due (never blocks)
+        void vFrameDone();                    // call after rendering a frame, to measure the frame time
+        uint8_t u8GetTargetFps();             // configured frame rate [1/s]
+        uint16_t u16GetFps();                 // measured frame rate of the last second [1/s]
+        unsigned long ulGetJitter();          // max. deviation from the frame period of the last second [us]
+        unsigned long ulGetFrameTime();       // max. render time of the last second [us]
+        unsigned long ulGetFrameBudget();     // allowed render time per frame [us]
+        uint32_t u32GetOverBudget();          // number of frames, which exceeded the render budget
+
+    private:
+        uint8_t       u8TargetFps      = FrameTimerFpsDefault;
+        unsigned long ulPeriod         = 0; // frame period [us]
+        unsigned long ulBudget         = 0; // render time budget [us]
+        unsigned long ulNextFrame      = 0; // timestamp of the next frame [us]
+        unsigned long ulLastFrame      = 0; // timestamp of the last frame [us]
+        unsigned long ulFrameStart     = 0; // timestamp of the current frame [us]
+        unsigned long ulWindowStart    = 0; // start of the measurement window [us]
+        uint16_t      u16WindowFrames  = 0;
+        unsigned long ulWindowJitter   = 0;
+        unsigned long ulWindowTime     = 0;
+        uint16_t      u16Fps           = 0;
+        unsigned long ulJitter         = 0;
+        unsigned long ulFrameTime      = 0;
+        uint32_t      u32OverBudget    = 0;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "GammaLut.h"
+
+// gamma 1/0.45 of NeoPixelBus (NeoEase::Gamma) in 16 bit, index: 8 bit value
+static const uint16_t au16Gamma[256] PROGMEM = {
+        0,     0,     1,     3,     6,    11,    16,    22,    30,    39,    49,    61,    74,    88,   104,   121,
+      139,   160,   181,   204,   229,   255,   283,   312,   343,   376,   410,   446,   484,   523,   564,   606,
+      651,   697,   745,   794,   845,   898,   953,  1010,  1068,  1129,  1191,  1255,  1320,  1388,  1458,  1529,
+     1602,  1677,  1754,  1833,  1914,  1997,  2081,  2168,  2257,  2347,  2440,  2534,  2631,  2729,  2829,  2932,
+     3036,  3143,  3251,  3362,  3474,  3589,  3705,  3824,  3945,  4067,  4192,  4319,  4448,  4579,  4713,  4848,
+     4985,  5125,  5267,  5410,  5556,  5704,  5855,  6007,  6161,  6318,  6477,  6638,  6801,  6966,  7134,  7304,
+     7476,  7650,  7826,  8005,  8186,  8369,  8554,  8741,  8931,  9123,  9317,  9514,  9712,  9913, 10117, 10322,
+    10530, 10740, 10952, 11167, 11384, 11603, 11825, 12048, 12275, 12503, 12734, 12967, 13202, 13440, 13680, 13923,
+    14168, 14415, 14664, 14916, 15170, 15427, 15686, 15947, 16211, 16477, 16745, 17016, 17289, 17565, 17843, 18123,
+    18406, 18692, 18979, 19269, 19562, 19857, 20154, 20454, 20756, 21061, 21368, 21678, 21990, 22304, 22621, 22940,
+    23262, 23587, 23913, 24243, 24574, 24909, 25245, 25584, 25926, 26270, 26617, 26966, 27318, 27672, 28029, 28388,
+    28750, 29114, 29481, 29850, 30222, 30596, 30973, 31353, 31735, 32119, 32506, 32896, 33288, 33683, 34080, 34480,
+    34883, 35288, 35695, 36105, 36518, 36933, 37351, 37772, 38195, 38621, 39049, 39480, 39913, 40349, 40788, 41229,
+    41673, 42120, 42569, 43021, 43475, 43932, 44392, 44854, 45319, 45787, 46257, 46730, 47205, 47683, 48164, 48648,
+    49134, 49622, 50114, 50608, 51105, 51604, 52106, 52611, 53119, 53629, 54142, 54657, 55175, 55696, 56220, 56746,
+    57275, 57807, 58341, 58878, 59418, 59960, 60506, 61054, 61604, 62158, 62714, 63272, 63834, 64398, 64965, 65535
+};
+
+// CIE L* lightness -> luminance in 16 bit, index: brightness (0..255 = L* 0..100),
+// the brightness steps look even instead of most of the range in the bottom 20%
+static const uint16_t au16CieBrightness[256] PROGMEM = {
+        0,    28,    57,    85,   114,   142,   171,   199,   228,   256,   285,   313,   341,   370,   398,   427,
+      455,   484,   512,   541,   569,   598,   627,   658,   689,   721,   755,   789,   825,   861,   899,   937,
+      977,  1018,  1060,  1103,  1147,  1192,  1239,  1287,  1336,  1386,  1437,  1490,  1544,  1599,  1656,  1714,
+     1773,  1834,  1896,  1959,  2024,  2090,  2157,  2226,  2297,  2369,  2442,  2517,  2593,  2671,  2751,  2832,
+     2914,  2999,  3085,  3172,  3261,  3352,  3444,  3538,  3634,  3732,  3831,  3932,  4035,  4139,  4245,  4354,
+     4464,  4575,  4689,  4804,  4922,  5041,  5162,  5285,  5410,  5537,  5666,  5797,  5930,  6065,  6202,  6341,
+     6482,  6626,  6771,  6918,  7068,  7220,  7373,  7529,  7687,  7848,  8010,  8175,  8342,  8512,  8683,  8857,
+     9033,  9212,  9393,  9576,  9762,  9949, 10140, 10333, 10528, 10725, 10926, 11128, 11333, 11541, 11751, 11963,
+    12179, 12396, 12617, 12840, 13065, 13293, 13524, 13757, 13993, 14232, 14474, 14718, 14965, 15215, 15467, 15722,
+    15980, 16241, 16505, 16771, 17041, 17313, 17588, 17866, 18147, 18431, 18717, 19007, 19300, 19596, 19894, 20196,
+    20501, 20809, 21119, 21433, 21750, 22071, 22394, 22720, 23050, 23383, 23719, 24058, 24400, 24746, 25095, 25447,
+    25802, 26161, 26523, 26888, 27257, 27629, 28004, 28383, 28765, 29151, 29540, 29932, 30328, 30728, 31131, 31537,
+    31947, 32360, 32777, 33198, 33622, 34050, 34481, 34916, 35355, 35797, 36243, 36693, 37146, 37603, 38064, 38529,
+    38997, 39469, 39945, 40425, 40908, 41396, 41887, 42382, 42881, 43384, 43891, 44401, 44916, 45435, 45957, 46484,
+    47015, 47549, 48088, 48631, 49178, 49728, 50283, 50843, 51406, 51973, 52545, 53120, 53700, 54284, 54873, 55465,
+    56062, 56663, 57269, 57878, 58492, 59111, 59733, 60360, 60992, 61627, 62268, 62912, 63561, 64215, 64873, 65535
+};
+
+//=======================================================================
+GammaLut::GammaLut() {
+    vBuildBalance();
+    vBuild();
+}
+
+//=======================================================================
+void GammaLut::vSetBrightness(uint8_t u8NewBrightness) {
+    if (u8NewBrightness == u8Brightness) return;
+    u8Brightness = u8NewBrightness;
+    vBuild();
+}
+
+//=======================================================================
+void GammaLut::vSetColorBalance(uint8_t u8NewRed, uint8_t u8NewGreen, uint8_t u8NewBlue) {
+    if (   (u8NewRed   == au8Balance[0])
+        && (u8NewGreen == au8Balance[1])
+        && (u8NewBlue  == au8Balance[2])) return;
+    au8Balance[0] = u8NewRed;
+    au8Balance[1] = u8NewGreen;
+    au8Balance[2] = u8NewBlue;
+    vBuildBalance();
+    vBuild();
+}
+
+//=======================================================================
+uint8_t GammaLut::u8GetBrightness() {
+    return u8Brightness;
+}
+
+//=======================================================================
+// the remainders start at 1/2, so the first frame is rounded
+void GammaLut::vSetDitherBuffer(uint8_t *pu8NewDitherRest, uint16_t u16NewLeds) {
+    pu8DitherRest = pu8NewDitherRest;
+    u16DitherLeds = pu8NewDitherRest ? u16NewLeds : 0;
+    if (pu8DitherRest) memset(pu8DitherRest, 0x80, (size_t)u16DitherLeds * GammaLutDitherBytes);
+}
+
+//=======================================================================
+void GammaLut::vStartFrame() {
+    u8LastFractions = u8Fractions;
+    u8Fractions     = 0;
+}
+
+//=======================================================================
+// a frame without fractions looks the same in every frame, it needn't be repeated
+bool GammaLut::boDithering() {
+    return (u8Fractions | u8LastFractions) && u16DitherLeds;
+}
+
+//=======================================================================
+// gain of the color balance, gamma(balance) * GammaLutOutputMax / 65535 in
+// 16.16 fixed point, three pow() only when the balance changes
+void GammaLut::vBuildBalance() {
+    for (uint8_t u8Channel = 0; u8Channel < 3; u8Channel++) {
+        au32BalanceGain[u8Channel] = (uint32_t)(NeoEase::Gamma(au8Balance[u8Channel] / 255.0f) * (GammaLutOutputMax * 65536.0f / 65535.0f) + 0.5f); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoEase
+    }
+}
+
+//=======================================================================
+// gamma(value * balance) = gamma(value) * gamma(balance): the 16 bit gamma
+// table is scaled by the balance gain and the perceptual brightness curve,
+// a brightness change costs one table lookup and 768 multiplications
+void GammaLut::vBuild() {
+    uint32_t u32Luminance = pgm_read_word(&au16CieBrightness[u8Brightness]);
+    for (uint8_t u8Channel = 0; u8Channel < 3; u8Channel++) {
+        uint32_t u32Gain = (u32Luminance * au32BalanceGain[u8Channel]) >> 16; // both 16 bit, the products fit into 32 bit
+        for (uint16_t u16Val = 0; u16Val < 256; u16Val++) {
+            au16Lut[u8Channel][u16Val] = (uint16_t)(((uint32_t)pgm_read_word(&au16Gamma[u16Val]) * u32Gain) >> 16);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef GammaLut_h
+#define GammaLut_h
+#include <Arduino.h>
+#include <NeoPixelBus.h> // see: https://github.com/Makuna/NeoPixelBus
+
+#define GammaLutOutputMax   65280 // 255.0 in 8.8 fixed point, the dither remainder adds at most 255
+#define GammaLutDitherBytes 3     // dither remainder per LED (R,G,B)
+#define GammaLutDitherLimit 0x2000 // 32.0 in 8.8 fixed point, a pixel with a brighter channel is rounded (power of 2)
+
+// Brightness (perceptual CIE L* curve), color balance and gamma correction
+// fused into one 16 bit lookup table per channel (3 * 256 * 2 byte). The tables
+// are only rebuilt, when the brightness or the color balance changes; per
+// pixel it's three table loads.
+// The 8.8 fixed point result is dithered down to the 8 bit of the stripe: each
+// LED keeps the remainder of its last frame (temporal error diffusion), so a
+// dim color averages to its exact value over a few frames instead of being
+// rounded to the next 8 bit step or to off. Only dim pixels are dithered,
+// above GammaLutDitherLimit one 8 bit step is below 3% and a static scene is
+// not repeated for its fractions.
+class GammaLut {
+    public:
+        GammaLut();
+        void vSetBrightness(uint8_t);                     // brightness (0..255), rebuilds the tables on change
+        void vSetColorBalance(uint8_t, uint8_t, uint8_t); // R,G,B scale (0..255, default 255:no correction)
+        uint8_t u8GetBrightness();                        // current brightness of the tables
+        void vSetDitherBuffer(uint8_t *, uint16_t);       // remainders (GammaLutDitherBytes per LED), LED count, NULL: round
+        void vStartFrame();                               // call before a frame is rendered
+        bool boDithering();                               // true, when the last frame has dim pixels, which need further frames to show their fractions
+        Rgb48Color rgbLinear(const RgbColor &rgbColor) {  // full brightness color -> stripe color [8.8 fixed point]
+            return Rgb48Color(au16Lut[0][rgbColor.R], au16Lut[1][rgbColor.G], au16Lut[2][rgbColor.B]);
+        }
+        RgbColor rgbDither(const Rgb48Color &rgbLinearColor, uint16_t u16Led) { // 8.8 stripe color -> 8 bit of this LED
+            uint16_t u16Any = rgbLinearColor.R | rgbLinearColor.G | rgbLinearColor.B; // >= limit, when one channel is
+            if ((u16Led >= u16DitherLeds) || (u16Any >= GammaLutDitherLimit)) {
+                return RgbColor((rgbLinearColor.R + 0x80) >> 8, (rgbLinearColor.G + 0x80) >> 8, (rgbLinearColor.B + 0x80) >> 8);
+            }
+            u8Fractions |= (uint8_t)u16Any;
+            uint8_t *pu8Rest = pu8DitherRest + (size_t)u16Led * GammaLutDitherBytes;
+            uint16_t u16R    = rgbLinearColor.R + pu8Rest[0];
+            uint16_t u16G    = rgbLinearColor.G + pu8Rest[1];
+            uint16_t u16B    = rgbLinearColor.B + pu8Rest[2];
+            pu8Rest[0] = (uint8_t)u16R;
+            pu8Rest[1] = (uint8_t)u16G;
+            pu8Rest[2] = (uint8_t)u16B;
+            return RgbColor(u16R >> 8, u16G >> 8, u16B >> 8);
+        }
+        RgbColor rgbCorrect(const RgbColor &rgbColor, uint16_t u16Led) { // full brightness color -> 8 bit of this LED
+            return rgbDither(rgbLinear(rgbColor), u16Led);
+        }
+
+    private:
+        void vBuild();
+        void vBuildBalance();
+        uint16_t au16Lut[3][256];
+        uint32_t au32BalanceGain[3];     // gamma of the color balance [1/65536]
+        uint8_t  au8Balance[3]   = {0xff, 0xff, 0xff};
+        uint8_t  u8Brightness    = 0xff;
+        uint8_t *pu8DitherRest   = NULL; // remainders of the last frame [1/256]
+        uint16_t u16DitherLeds   = 0;
+        uint8_t  u8Fractions     = 0;    // OR of the fractions of the current frame
+        uint8_t  u8LastFractions = 0;    // OR of the fractions of the last frame
+};
+
+#endif
@@ -1,22 +1,16 @@
+#include <new>
 #include "LedStripe.h"
+#include "ColorUtils.h"
 #include "Utils.h"
 #include "DebugLevel.h"
 
 #define CLASS_NAME "LedStripe"
 
-const RgbColor rgbOff = RgbColor(HsbColor(0, 0, 0));
-const uint8_t u8DimMatrix[5][6] = {
-  // 0  1  2  3  4  5   // LED index
-    {1, 0, 0, 0, 0, 0}, // DimLevel 0
-    {1, 0, 0, 1, 0, 0}, // DimLevel 1
-    {1, 0, 0, 1, 1, 0}, // DimLevel 2
-    {1, 1, 0, 1, 1, 0}, // DimLevel 3
-    {1, 1, 1, 1, 1, 0}  // DimLevel 4
-};
-
 //=============================================================================
 LedStripe::LedStripe(uint8_t u8NewDebugLevel) {
     u8DebugLevel = u8NewDebugLevel;
+    cAnimation   = new Animation(u8NewDebugLevel);
+    vResetEffects();
 }
 
 //=============================================================================
@@ -24,18 +18,53 @@ void LedStripe::vInit(class Eep *pNewEep, class NtpTime *pNewNtpTime) {
     pEep     = pNewEep;
     pNtpTime = pNewNtpTime;
 
-    // For Esp8266, the Pin is omitted and it uses GPIO3 due to DMA hardware use.
-    strip = new NeoPixelBus<NeoGrbFeature, Neo800KbpsMethod>(pEep->u16LedCount);
-    // this resets all the neopixels to an off state
-    strip->Begin(); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-begin
-    strip->Show();  // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-showbool-maintainbufferconsistency--true
+    cFrameTimer->vSetFps(pEep->u8FrameRate);
+    cGammaLut.vSetColorBalance(pEep->u8BalanceRed, pEep->u8BalanceGreen, pEep->u8BalanceBlue);
+
+    if (!pu8Arena) vAllocArena(); // once, before the first bus
+    uint16_t u16LedCount = pEep->u16LedCount;
+    if (!boLedCountFits(u16LedCount)) {
+        // refuse the LedCount until the next start, keep the current one instead
+        // of running out of memory, the configured LedCount stays stored
+        u16LedCount = strip ? strip->PixelCount() : LedCountDefault;
+        if (!boLedCountFits(u16LedCount)) u16LedCount = u16LedCountLimit();
+        if (!u16LedCount) u16LedCount = 1;
+        if (u8DebugLevel & DEBUG_LED_EVENTS) {
+            char buffer[100];
+            sprintf(buffer, " LedCount:%d doesn't fit into FreeHeap:%lu, use LedCount:%d",
+                pEep->u16LedCount, (unsigned long)ESP.getFreeHeap(), u16LedCount);
+            vConsole(u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+        }
+    }
+
+    if (!strip || (strip->PixelCount() != u16LedCount)) {
+        // recreate the bus only when the LedCount changed, the arena is kept
+        vHeapReport("before");
+        if (strip) {
+            strip->~NeoPixelBus(); // waits for a running transmission, frees the pixel and DMA buffers
+            strip = NULL;
+        }
+        if (pu8Arena) cGammaLut.vSetDitherBuffer(pu8FadeFrame + (size_t)u16ArenaLeds * LedFadeBytesPerLed, u16ArenaLeds); // the remainders of the old LEDs are void
+        boFading               = false;
+        vResetEffects();                  // the effect state is lost
+        vBuildMatrixMap();
+        // the bus object itself lives in au8StripeMem, only its buffers are on the heap
+        // For Esp8266, the Pin is omitted and it uses GPIO3 due to DMA hardware use.
+        strip = new (au8StripeMem) tNeoStripe(u16LedCount);
+        boFramePending = false;
+        // this resets all the neopixels to an off state
+        strip->Begin(); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-begin
+        vShow(true);    // new bus, send the frame in any case
+        vHeapReport("after");
+    }
 
     if (u8DebugLevel & DEBUG_LED_EVENTS) {
         char buffer[100];
-        sprintf(buffer, " LedCount:%d", pEep->u16LedCount);
+        sprintf(buffer, " LedCount:%d", strip->PixelCount());
         sprintf(buffer, "%s Hue:0x%04x", buffer, pEep->u16Hue);
         sprintf(buffer, "%s Sat:0x%02x", buffer, pEep->u8Saturation);
         sprintf(buffer, "%s Bri:0x%02x", buffer, u8GetBrightness());
+        sprintf(buffer, "%s EffectState:%dByte", buffer, (int)(u16ArenaLeds * LedArenaBytesPerLed));
         vConsole( u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
     }
     if (pEep->u8PowerOnRestoreSwitch) {
@@ -65,26 +94,18 @@ void LedStripe::vSetColorMode(tColorMode enNewColorMode, uint8_t clientNumber){
     vSetColor(clientNumber); // switch to the current mode
 }
 
+//=============================================================================
+void LedStripe::vSetPalette(uint8_t u8NewPalette, uint8_t clientNumber){
+    pEep->vSetPalette(u8NewPalette, true); // store the new palette
+    vSetColor(clientNumber);               // crossfade to the new palette
+}
+
 //=============================================================================
 void LedStripe::vSetColor(uint8_t clientNumber){
     if (boGetSwitchStatus()) {
         // when stripe is on
-        switch ((tColorMode)pEep->u8ColorMode) {
-            case nMonochrome: // use the same color of all pixels, but shift the color smoothly
-                vSetMonochrome(pEep->u16Hue, pEep->u8Saturation, u8GetBrightness(), pEep->u8Speed);
-                break;
-            case nRainbow: // draw a rainbow and shift/move the colors
-                vSetRainbow(pEep->u16Hue, pEep->u8Saturation, u8GetBrightness(), pEep->u8Speed);
-                break;
-            case nRandom: // change for each pixel color individually, but smooth
-                vSetRandom(pEep->u8Saturation, u8GetBrightness(), false, pEep->u8Speed);
-                break;
-            case nMovingPoint: // change for each pixel color individually, but smooth
-                vSetMovingPoint(pEep->u16Hue, pEep->u8Saturation, u8GetBrightness(), false);
-                break;
-            default:
-                break;
-        }
+        vStartFade();
+        vRender(u8GetBrightness());
     }
     if (pWebServer && !boDistanceSensCalibActive)
         pWebServer->vSendStripeStatus(clientNumber, true); // update values for every web client
@@ -102,7 +123,7 @@ void LedStripe::vTurn( bool boNewMode, bool boFast) {
         pEep->vSetBrightnessDay(pEep->u8BrightnessDay, true);
         pEep->vSetBrightnessNight(pEep->u8BrightnessNight, true);
     } else {
-        boInitRandomHue = true;
+        vResetEffects(); // initialize the effects again, e.g. new random colors
     }
     if (pEep->u8PowerOnRestoreSwitch) {
         // store switch status in EEP
@@ -115,27 +136,12 @@ void LedStripe::vTurn( bool boNewMode, bool boFast) {
         boCurrentSwitchMode = boNewMode;
         if (boNewMode) {
             vConsole( u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, "fast ON" );
-            switch ((tColorMode)pEep->u8ColorMode) {
-                case nMonochrome: // use the same color of all pixels, but shift the color smoothly
-                    vSetMonochrome(pEep->u16Hue, pEep->u8Saturation, u8GetBrightness(), pEep->u8Speed);
-                    break;
-                case nRainbow: // draw a rainbow and shift/move the colors
-                    vSetRainbow(pEep->u16Hue, pEep->u8Saturation, u8GetBrightness(), pEep->u8Speed);
-                    break;
-                case nRandom: // change for each pixel color individually, but smooth
-                    vSetRandom(pEep->u8Saturation, u8GetBrightness(), boInitRandomHue, pEep->u8Speed);
-                    boInitRandomHue = false;
-                    break;
-                case nMovingPoint: // change for each pixel color individually, but smooth
-                    vSetMovingPoint(pEep->u16Hue, pEep->u8Saturation, u8GetBrightness(), false);
-                    break;
-                default:
-                    break;
-            }
+            vRender(u8GetBrightness());
         } else {
             vConsole( u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, "fast OFF" );
+            boFading = false;
             strip->Begin();
-            strip->Show();
+            vShow(false);
         }
     } else {
         // switch smooth
@@ -179,261 +185,543 @@ void LedStripe::vSetValues(
 }
 
 //=============================================================================
+// render the monochrome effect with explicit values on the whole stripe
+// (e.g. white for the distance sensor calibration), segments are ignored
 void LedStripe::vSetMonochrome(
     uint16_t u16NewHue,
     uint8_t u8NewSaturation,
     uint8_t u8NewBrightness,
     uint8_t u8Speed)
 {
-    // limit the brightness
+    tEffectParams stParams;
+    unsigned long ulNow = ulPrepareFrame(u8NewBrightness, stParams);
+    tSegment stStripe = {0, strip->PixelCount(), u16NewHue, nMonochrome, u8NewSaturation, u8Speed, 0xff};
+    vRenderSegment(astRuns[0], stStripe, stParams, ulNow);
+    if (stStripe.u16Hue != u16NewHue) pEep->u16Hue = stStripe.u16Hue; // the effect shifted the hue
+    vFinishFrame(ulNow, stParams.u32ChannelSum);
+}
+
+//=============================================================================
+// Render the configured effect with the given (e.g. damped) brightness. With
+// segments, they are rendered in LED order and the LEDs between them are off,
+// so each pixel is written once per frame, independent of the segment count.
+void LedStripe::vRender(uint8_t u8NewBrightness) {
+    tEffectParams stParams;
+    unsigned long ulNow = ulPrepareFrame(u8NewBrightness, stParams);
+
+    if (!pEep->u8SegmentCount) {
+        // whole stripe with the global values
+        tSegment stStripe = {0, strip->PixelCount(), pEep->u16Hue, pEep->u8ColorMode, pEep->u8Saturation, pEep->u8Speed, 0xff};
+        vRenderSegment(astRuns[0], stStripe, stParams, ulNow);
+        pEep->u16Hue = stStripe.u16Hue; // the effect may have shifted the hue
+    } else {
+        uint16_t u16LedCount = strip->PixelCount();
+        uint16_t u16NextLed  = 0;
+        for (uint8_t u8Idx = 0; u8Idx < pEep->u8SegmentCount; u8Idx++) {
+            tSegment stSegment = pEep->astSegments[u8Idx];
+            if ((stSegment.u16Start < u16NextLed) || (stSegment.u16Start >= u16LedCount)) continue; // overlapping or behind the stripe
+            if (stSegment.u16Count > (u16LedCount - stSegment.u16Start)) stSegment.u16Count = u16LedCount - stSegment.u16Start;
+            if (!stSegment.u16Count) continue;
+
+            if (stSegment.u16Start > u16NextLed) strip->ClearTo(RgbColor(0), u16NextLed, stSegment.u16Start - 1);
+            vRenderSegment(astRuns[u8Idx], stSegment, stParams, ulNow);
+            pEep->astSegments[u8Idx].u16Hue = stSegment.u16Hue; // the effect may have shifted the hue
+            u16NextLed = stSegment.u16Start + stSegment.u16Count;
+        }
+        if (u16NextLed < u16LedCount) strip->ClearTo(RgbColor(0), u16NextLed, u16LedCount - 1);
+    }
+    vFinishFrame(ulNow, stParams.u32ChannelSum);
+}
+
+//=============================================================================
+// Shared part of all effects and segments: brightness limit, tables and the
+// animation time are calculated once per frame.
+unsigned long LedStripe::ulPrepareFrame(uint8_t u8NewBrightness, tEffectParams &stParams) {
+    // limit the brightness, only the smooth on/off goes below the min.
+    // brightness, the dithered 16 bit tables dim all pixels continuously down to off
     uint8_t u8SetBrightness = u8NewBrightness;
-    if (u8NewBrightness <= pEep->u8BrightnessMin) { u8SetBrightness = pEep->u8BrightnessMin; }
+    if ((u8NewBrightness <= pEep->u8BrightnessMin) && (boNewSwitchMode == boCurrentSwitchMode)) { u8SetBrightness = pEep->u8BrightnessMin; }
     if (u8NewBrightness >= pEep->u8BrightnessMax) { u8SetBrightness = pEep->u8BrightnessMax; }
-
-    if (pEep->u8Speed) { // change the color also during on/off dimming
-        u16NewHue += (uint16_t)pEep->u8Speed;
-        pEep->u16Hue = u16NewHue;
+    cGammaLut.vSetBrightness(u8SetBrightness);
+    cGammaLut.vStartFrame();
+
+    // the animation advances with the time, not per call, independent of the loop rate
+    unsigned long ulNow     = millis();
+    unsigned long ulDeltaMs = ulNow - ulLastRenderTime;
+    if (ulDeltaMs > EffectMaxDeltaMs) ulDeltaMs = EffectMaxDeltaMs; // continue smoothly after a stall
+    ulLastRenderTime = ulNow;
+
+    if (pEep->u8Palette != u8ActivePalette) {
+        // the gradient is read from the flash only when the palette changes
+        vExpandPalette(pEep->u8Palette, aPalette);
+        u8ActivePalette = pEep->u8Palette;
     }
 
-    RgbColor rgbGammaColor = colorGamma.Correct( // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoGamma-object#rgbcolor-correctrgbcolor-original
-        RgbColor(                                // see: https://github.com/Makuna/NeoPixelBus/wiki/RgbColor-object-API
-            HsbColor(                            // see: https://github.com/Makuna/NeoPixelBus/wiki/HsbColor-object-API
-                (float)u16NewHue / (float)0xffff,
-                (float)u8NewSaturation / (float)0xff,
-                (float)u8SetBrightness / (float)0xff)));
+    stParams.u16DeltaMs    = (uint16_t)ulDeltaMs;
+    stParams.pPalette      = aPalette;
+    stParams.u32ChannelSum = 0;
+    stParams.pAnimation    = cAnimation;
+    stParams.pGammaLut     = &cGammaLut;
+    return ulNow;
+}
 
-    if (u8NewBrightness > pEep->u8BrightnessMin) {
-        strip->ClearTo(rgbGammaColor); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-cleartocolorobject-color
+//=============================================================================
+// render one segment with the effect of the registry, the shifted hue is
+// returned in stSegment
+void LedStripe::vRenderSegment(
+    tSegmentRun &stRun,
+    tSegment &stSegment,
+    tEffectParams &stParams,
+    unsigned long ulNow)
+{
+    if (stSegment.u8ColorMode >= nNoMode) return;
+    const tEffect *pstEffect = &astEffects[stSegment.u8ColorMode];
+
+    uint32_t u32HueShift  = (uint32_t)stSegment.u8Speed * EffectHueRatePerSpeed * stParams.u16DeltaMs + stRun.u32HueRemainder; // [1/1000]
+    stRun.u32HueRemainder = u32HueShift % 1000;
+
+    stParams.u16FirstLed   = stSegment.u16Start;
+    stParams.u16LedCount   = stSegment.u16Count;
+    stParams.u16Hue        = stSegment.u16Hue;
+    stParams.u8Saturation  = stSegment.u8Saturation;
+    stParams.u8Value       = stSegment.u8Brightness;
+    stParams.u8Speed       = stSegment.u8Speed;
+    stParams.u16HueStep    = (uint16_t)(u32HueShift / 1000);
+    stParams.pu8PixelState = (pu8Arena && (u16ArenaLeds >= strip->PixelCount()))
+                               ? (pu8Arena + (size_t)stSegment.u16Start * LedStateBytesPerLed)
+                               : NULL;
+    if (u16MatrixLeds && !stSegment.u16Start && (u16MatrixLeds <= stSegment.u16Count)) {
+        // the matrix starts with the first LED, the layout is in the map
+        stParams.u16Width  = pEep->u8MatrixWidth;
+        stParams.u16Height = pEep->u8MatrixHeight;
+        stParams.pu16Map   = pu16MatrixMap;
     } else {
-        uint8_t u8DimLevel = (uint8_t)((float)u8NewBrightness / (float)((float)pEep->u8BrightnessMin / (float)4)); // 0,1,2,3,4
-        for (uint16_t u16LedIdx = 0; u16LedIdx < pEep->u16LedCount; u16LedIdx++) {
-            // loop over all pixels
-            strip->SetPixelColor( // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
-                u16LedIdx,
-                u8DimMatrix[u8DimLevel][u16LedIdx % 6] ? rgbGammaColor : rgbOff);
+        // a linear stripe is a matrix with one row
+        stParams.u16Width  = stSegment.u16Count;
+        stParams.u16Height = 1;
+        stParams.pu16Map   = NULL;
+    }
+
+    if (stSegment.u8ColorMode != stRun.enActiveEffect) {
+        // the effect takes over the per LED state of the segment
+        stRun.enActiveEffect = (tColorMode)stSegment.u8ColorMode;
+        if (pstEffect->vInit) pstEffect->vInit(stParams, &stRun.stState);
+        if (u8DebugLevel & DEBUG_LED_EVENTS) {
+            char buffer[100];
+            sprintf(buffer, " Effect:%s Led:%d..%d", pstEffect->pcName, stSegment.u16Start, stSegment.u16Start + stSegment.u16Count - 1);
+            vConsole(u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
         }
     }
-    strip->Show();
+    pstEffect->vRender(strip, ulNow, stParams, &stRun.stState);
+    stSegment.u16Hue = stParams.u16Hue;
 
     if (u8DebugLevel & DEBUG_LED_DETAILS) {
         char buffer[100];
-        sprintf(buffer, " Hue:0x%04x", u16NewHue);
-        sprintf(buffer, "%s Sat:0x%02x", buffer, u8NewSaturation);
-        sprintf(buffer, "%s Bri:0x%02x", buffer, u8NewBrightness);
-        sprintf(buffer, "%s RGB:0x%02x%02x%02x", buffer, rgbGammaColor.R, rgbGammaColor.G, rgbGammaColor.B);
+        sprintf(buffer, " %s Led:%d Hue:0x%04x", pstEffect->pcName, stSegment.u16Start, stParams.u16Hue);
+        sprintf(buffer, "%s Sat:0x%02x", buffer, stSegment.u8Saturation);
+        sprintf(buffer, "%s Bri:0x%02x", buffer, cGammaLut.u8GetBrightness());
         vConsole(u8DebugLevel, DEBUG_LED_DETAILS, CLASS_NAME, __FUNCTION__, buffer);
     }
+}
 
+//=============================================================================
+// u32ChannelSum: R+G+B of all pixels, summed up by the effects while rendering
+void LedStripe::vFinishFrame(unsigned long ulNow, uint32_t u32ChannelSum) {
+    vReleaseAnimation();
+    if (boFading) vBlendFrame(ulNow, u32ChannelSum);
+    vLimitPower(u32ChannelSum);
+    vShow(false);
 }
 
 //=============================================================================
-void LedStripe::vSetRainbow(
-    uint16_t u16NewStartHue,
-    uint8_t u8NewSaturation,
-    uint8_t u8NewBrightness,
-    uint8_t u8Speed)
-{
-    // limit the brightness
-    uint8_t u8SetBrightness = u8NewBrightness;
-    if (u8NewBrightness <= pEep->u8BrightnessMin) { u8SetBrightness = pEep->u8BrightnessMin; }
-    if (u8NewBrightness >= pEep->u8BrightnessMax) { u8SetBrightness = pEep->u8BrightnessMax; }
-    uint8_t u8DimLevel = (uint8_t)((float)u8NewBrightness / (float)((float)pEep->u8BrightnessMin / (float)4)); // 0,1,2,3,4
+// Estimate the current of the frame (linear in the channel values) and scale
+// the frame down, when it exceeds the power budget. Only a limited frame costs
+// a pass over the pixel buffer, the estimation is done while rendering.
+void LedStripe::vLimitPower(uint32_t u32ChannelSum) {
+    u8PowerScale = 0xff;
+    if (!pEep->u16PowerBudget) return;
+
+    uint32_t u32IdleMilliAmp = (uint32_t)strip->PixelCount() * LedMilliAmpIdle;
+    uint32_t u32MilliAmp     = u32IdleMilliAmp + u32ChannelSum * LedMilliAmpPerChannel / 255;
+    if (u32MilliAmp <= pEep->u16PowerBudget) return;
+
+    u8PowerScale = (pEep->u16PowerBudget <= u32IdleMilliAmp)
+                       ? 0
+                       : (uint8_t)((pEep->u16PowerBudget - u32IdleMilliAmp) * 255 / (u32MilliAmp - u32IdleMilliAmp));
+    uint16_t u16Scale = (uint16_t)u8PowerScale + 1;
+    uint8_t *pu8Pixel = strip->Pixels();
+    uint8_t *pu8End   = pu8Pixel + strip->PixelsSize();
+    while (pu8Pixel < pu8End) {
+        *pu8Pixel = (uint8_t)((*pu8Pixel * u16Scale) >> 8);
+        pu8Pixel++;
+    }
+}
 
-    // calculate saturation and brightness
-    float fSaturation = (float)u8NewSaturation / (float)0xff;
-    float fBrightness = (float)u8SetBrightness / (float)0xff;
+//=============================================================================
+void LedStripe::vSetPowerBudget(uint16_t u16NewPowerBudget) {
+    pEep->vSetPowerBudget(u16NewPowerBudget, true);
+    vSetColor(-1); // apply the new budget at once
+}
 
-    if (pEep->u8Speed) { // change the color also during on/off dimming
-        u16NewStartHue += (uint16_t)pEep->u8Speed;
-        pEep->u16Hue = u16NewStartHue;
+//=============================================================================
+uint8_t LedStripe::u8GetPowerScale() {
+    return u8PowerScale;
+}
+
+//=============================================================================
+// true, when the stripe or at least one segment has an animation speed or
+// plays the animation (it has its own frame period)
+bool LedStripe::boAnimated() {
+    if (!pEep->u8SegmentCount) return pEep->u8Speed || (pEep->u8ColorMode == nAnimation);
+    for (uint8_t u8Idx = 0; u8Idx < pEep->u8SegmentCount; u8Idx++) {
+        if (pEep->astSegments[u8Idx].u8Speed || (pEep->astSegments[u8Idx].u8ColorMode == nAnimation)) return true;
     }
+    return false;
+}
 
-    for (uint16_t u16LedIdx = 0; u16LedIdx < pEep->u16LedCount; u16LedIdx++) {
-        // loop over all pixels
-        uint16_t u16PixelHue = u16NewStartHue + (u16LedIdx * 65536L / pEep->u16LedCount);
-        strip->SetPixelColor( // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
-            u16LedIdx,
-            colorGamma.Correct( // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoGamma-object#rgbcolor-correctrgbcolor-original
-                RgbColor(       // see: https://github.com/Makuna/NeoPixelBus/wiki/RgbColor-object-API
-                    HsbColor(   // see: https://github.com/Makuna/NeoPixelBus/wiki/HsbColor-object-API
-                        (float)u16PixelHue / (float)0xffff,
-                        fSaturation,
-                        (u8NewBrightness > pEep->u8BrightnessMin) ? fBrightness : (u8DimMatrix[u8DimLevel][u16LedIdx % 6] ? fBrightness : 0)
-                    )
-                )
-            )
-        );
+//=============================================================================
+// the frame buffers of the animation are only allocated, while it's shown
+void LedStripe::vReleaseAnimation() {
+    if (!cAnimation->boIsOpen()) return;
+    for (uint8_t u8Idx = 0; u8Idx < SegmentsMax; u8Idx++) {
+        if (astRuns[u8Idx].enActiveEffect == nAnimation) return;
     }
-    strip->Show();
+    cAnimation->vClose();
 }
 
 //=============================================================================
-void LedStripe::vSetRandom(
-    uint8_t u8NewSaturation,
-    uint8_t u8NewBrightness,
-    bool boInitNewColors,
-    uint8_t u8Speed)
-{
-    static uint16_t aHue[300];
+// after an upload (complete or not) a run with the animation effect plays the
+// new file, also when there was no valid file, when the effect was selected
+void LedStripe::vAnimationUpload(bool boStart) {
+    cAnimation->vSetUploading(boStart);
+    if (boStart) return;
+    for (uint8_t u8Idx = 0; u8Idx < SegmentsMax; u8Idx++) {
+        if (astRuns[u8Idx].enActiveEffect == nAnimation) {
+            cAnimation->vReopen();
+            return;
+        }
+    }
+}
 
-    // limit the brightness
-    uint8_t u8SetBrightness = u8NewBrightness;
-    if (u8NewBrightness <= pEep->u8BrightnessMin) { u8SetBrightness = pEep->u8BrightnessMin; }
-    if (u8NewBrightness >= pEep->u8BrightnessMax) { u8SetBrightness = pEep->u8BrightnessMax; }
-    uint8_t u8DimLevel = (uint8_t)((float)u8NewBrightness / (float)((float)pEep->u8BrightnessMin / (float)4)); // 0,1,2,3,4
+//=============================================================================
+// all effects are initialized again with their next frame
+void LedStripe::vResetEffects() {
+    for (uint8_t u8Idx = 0; u8Idx < SegmentsMax; u8Idx++) {
+        astRuns[u8Idx].enActiveEffect  = nNoMode;
+        astRuns[u8Idx].u32HueRemainder = 0;
+        memset(&astRuns[u8Idx].stState, 0, sizeof(tEffectState));
+    }
+}
 
-    float fSaturation = (float)u8NewSaturation / (float)0xff;
-    float fBrightness = (float)u8SetBrightness / (float)0xff;
+//=============================================================================
+// A segment must not overlap its neighbours, segments are kept in LED order.
+bool LedStripe::boSetSegment(uint8_t u8Idx, const tSegment &stNewSegment) {
+    if ((u8Idx >= SegmentsMax) || (stNewSegment.u8ColorMode >= nNoMode) || !stNewSegment.u16Count) return false;
+    if (((uint32_t)stNewSegment.u16Start + stNewSegment.u16Count) > pEep->u16LedCount) return false;
+    if (u8Idx > 0) {
+        const tSegment &stPrev = pEep->astSegments[u8Idx - 1];
+        if (stNewSegment.u16Start < (stPrev.u16Start + stPrev.u16Count)) return false;
+    }
+    if ((u8Idx + 1) < pEep->u8SegmentCount) {
+        const tSegment &stNext = pEep->astSegments[u8Idx + 1];
+        if ((stNewSegment.u16Start + stNewSegment.u16Count) > stNext.u16Start) return false;
+    }
+    pEep->vSetSegment(u8Idx, stNewSegment, true);
+    astRuns[u8Idx].enActiveEffect = nNoMode; // range or mode may have changed
+    return true;
+}
 
-    for(uint16_t u16LedIdx=0; u16LedIdx < pEep->u16LedCount; u16LedIdx++) {
-        if (boInitNewColors) {
-            aHue[u16LedIdx] = random(0x0000, 0xffff);
-        } else if (u8Speed) {
-            if (u16LedIdx & 0x0001) {
-                aHue[u16LedIdx] += random(0,u8Speed);
-            } else {
-                aHue[u16LedIdx] -= random(0, u8Speed);
-            }
+//=============================================================================
+void LedStripe::vSetSegmentCount(uint8_t u8NewSegmentCount) {
+    pEep->vSetSegmentCount(u8NewSegmentCount, true);
+    vResetEffects();
+}
+
+//=============================================================================
+bool LedStripe::boSetMatrix(uint8_t u8Width, uint8_t u8Height, uint8_t u8Layout) {
+    if (u8Layout >= nNoLayout) return false;
+    if (((uint16_t)u8Width * u8Height) > LedCountMax) return false;
+    pEep->vSetMatrix(u8Width, u8Height, u8Layout, true);
+    vBuildMatrixMap();
+    vResetEffects(); // the 2D effects start again with the new size
+    return true;
+}
+
+//=============================================================================
+// fill the map with the layout of NeoPixelBus, the only place of layout math
+template <typename T_LAYOUT> static void vFillMatrixMap(uint16_t *pu16Map, uint8_t u8Width, uint8_t u8Height) {
+    NeoTopology<T_LAYOUT> cTopology(u8Width, u8Height); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoTopology-object-API
+    for (uint8_t u8Y = 0; u8Y < u8Height; u8Y++) {
+        for (uint8_t u8X = 0; u8X < u8Width; u8X++) {
+            *pu16Map++ = cTopology.Map(u8X, u8Y);
         }
-        strip->SetPixelColor( // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
-            u16LedIdx,
-            colorGamma.Correct( // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoGamma-object#rgbcolor-correctrgbcolor-original
-                RgbColor(       // see: https://github.com/Makuna/NeoPixelBus/wiki/RgbColor-object-API
-                    HsbColor(   // see: https://github.com/Makuna/NeoPixelBus/wiki/HsbColor-object-API
-                        (float)aHue[u16LedIdx] / (float)0xffff,
-                        fSaturation,
-                        (u8NewBrightness > pEep->u8BrightnessMin) ? fBrightness : (u8DimMatrix[u8DimLevel][u16LedIdx % 6] ? fBrightness : 0)
-                    )
-                )
-            )
-        );
     }
-    strip->Show();
 }
 
 //=============================================================================
-void LedStripe::vSetMovingPoint(
-    uint16_t u16NewHue,
-    uint8_t u8NewSaturation,
-    uint8_t u8NewBrightness,
-    bool boMove)
-{
-    static uint16_t u16Pos  = 0;
-    static bool boDirection = false;
+// Precalculate the LED of each matrix position, the 2D effects only look it up.
+// Without a matrix or when it doesn't fit into the stripe, the effects run linear.
+void LedStripe::vBuildMatrixMap() {
+    uint16_t u16Leds = (uint16_t)pEep->u8MatrixWidth * pEep->u8MatrixHeight;
+    u16MatrixLeds = 0;
+    if (!u16Leds || !pu16MatrixMap || (u16Leds > u16ArenaLeds)) return;
+
+    switch (pEep->u8MatrixLayout) {
+        case nRowMajor:               vFillMatrixMap<RowMajorLayout>(pu16MatrixMap, pEep->u8MatrixWidth, pEep->u8MatrixHeight); break;
+        case nRowMajorAlternating:    vFillMatrixMap<RowMajorAlternatingLayout>(pu16MatrixMap, pEep->u8MatrixWidth, pEep->u8MatrixHeight); break;
+        case nColumnMajor:            vFillMatrixMap<ColumnMajorLayout>(pu16MatrixMap, pEep->u8MatrixWidth, pEep->u8MatrixHeight); break;
+        case nColumnMajorAlternating: vFillMatrixMap<ColumnMajorAlternatingLayout>(pu16MatrixMap, pEep->u8MatrixWidth, pEep->u8MatrixHeight); break;
+        default: return;
+    }
+    u16MatrixLeds = u16Leds;
+    if (u8DebugLevel & DEBUG_LED_EVENTS) {
+        char buffer[100];
+        sprintf(buffer, " Matrix:%dx%d Layout:%d", pEep->u8MatrixWidth, pEep->u8MatrixHeight, pEep->u8MatrixLayout);
+        vConsole(u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+    }
+}
 
-    // limit the brightness
-    uint8_t u8SetBrightness = u8NewBrightness;
-    if (u8NewBrightness <= pEep->u8BrightnessMin) { u8SetBrightness = pEep->u8BrightnessMin; }
-    if (u8NewBrightness >= pEep->u8BrightnessMax) { u8SetBrightness = pEep->u8BrightnessMax; }
+//=============================================================================
+// Keep the currently shown frame as the outgoing frame of a crossfade. The new
+// effect renders into the pixel buffer and vBlendFrame() mixes both, until the
+// fade time is over. A fade during a fade starts from the blended frame.
+void LedStripe::vStartFade() {
+    if (!u16FadeTime || !pu8FadeFrame || (u16ArenaLeds < strip->PixelCount())) return;
+    if (!boCurrentSwitchMode || !boNewSwitchMode) return; // on/off has its own dimming
+
+    memcpy(pu8FadeFrame, strip->Pixels(), strip->PixelsSize());
+    ulFadeStartTime = millis();
+    boFading        = true;
+}
 
-    float fHue              = (float)u16NewHue / (float)0xffff;
-    float fSaturation       = (float)u8NewSaturation / (float)0xff;
-    float fBrightness       = (float)u8SetBrightness / (float)0xff;
+//=============================================================================
+// integer lerp of each color byte: new frame weight 0..256 over the fade time,
+// u32ChannelSum is replaced by the sum of the blended frame
+void LedStripe::vBlendFrame(unsigned long ulNow, uint32_t &u32ChannelSum) {
+    unsigned long ulFadeTime = ulNow - ulFadeStartTime;
+    if (ulFadeTime >= u16FadeTime) {
+        boFading = false; // the new frame is complete
+        return;
+    }
+    int32_t i32Weight = (int32_t)((ulFadeTime << 8) / u16FadeTime);
+
+    uint8_t       *pu8Pixel = strip->Pixels();
+    uint8_t       *pu8End   = pu8Pixel + strip->PixelsSize();
+    const uint8_t *pu8Old   = pu8FadeFrame;
+    u32ChannelSum = 0;
+    while (pu8Pixel < pu8End) {
+        int32_t i32Diff = (int32_t)*pu8Pixel - *pu8Old;
+        *pu8Pixel       = (uint8_t)(*pu8Old++ + ((i32Diff * i32Weight) >> 8));
+        u32ChannelSum  += *pu8Pixel++;
+    }
+}
 
-    if (boMove) {
-        if (boDirection) {
-            if (++u16Pos >= pEep->u16LedCount) {
-                u16Pos -= 2;
-                boDirection = !boDirection;
-            }
-        } else {
-            if (u16Pos > 0) {
-                --u16Pos;
-            } else {
-                ++u16Pos;
-                boDirection = !boDirection;
-            }
-        }
+//=============================================================================
+void LedStripe::vSetFadeTime(uint16_t u16NewFadeTime) {
+    u16FadeTime = u16NewFadeTime;
+    if (!u16FadeTime) boFading = false;
+}
+
+//=============================================================================
+// The effect state, the matrix map, the crossfade frame and the dither
+// remainders (LedArenaBytesPerLed) are allocated once for the largest LedCount,
+// whose arena and bus fit into the heap next to LedHeapReserve (max.
+// LedCountMax). A LedCount change only recreates the bus, the arena is never
+// freed and can't fragment the heap.
+void LedStripe::vAllocArena() {
+    uint32_t u32Free = ESP.getFreeHeap();
+    uint32_t u32Leds = (u32Free > LedHeapReserve) ? (u32Free - LedHeapReserve) / (LedBusBytesPerLed + LedArenaBytesPerLed) : 0;
+    if (u32Leds > (ESP.getMaxFreeBlockSize() / LedArenaBytesPerLed)) u32Leds = ESP.getMaxFreeBlockSize() / LedArenaBytesPerLed;
+    if (u32Leds > LedCountMax) u32Leds = LedCountMax;
+    pu8Arena = u32Leds ? (uint8_t *)malloc(u32Leds * LedArenaBytesPerLed) : NULL;
+    if (!pu8Arena && (pEep->u16LedCount < u32Leds)) {
+        // at least the configured LedCount
+        u32Leds  = pEep->u16LedCount;
+        pu8Arena = (uint8_t *)malloc(u32Leds * LedArenaBytesPerLed);
     }
-    for (uint16_t u16LedIdx = 0; u16LedIdx < pEep->u16LedCount; u16LedIdx++) {
-        strip->SetPixelColor( // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-setpixelcoloruint16_t-indexpixel-colorobject-color
-            u16LedIdx,
-            colorGamma.Correct( // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoGamma-object#rgbcolor-correctrgbcolor-original
-                RgbColor(       // see: https://github.com/Makuna/NeoPixelBus/wiki/RgbColor-object-API
-                    HsbColor(   // see: https://github.com/Makuna/NeoPixelBus/wiki/HsbColor-object-API
-                        fHue,
-                        fSaturation,
-                        u16Pos == u16LedIdx ? fBrightness : 0
-                    )
-                )
-            )
-        );
+    u16ArenaLeds  = pu8Arena ? (uint16_t)u32Leds : 0;
+    // the map follows the 4 byte state, so it is 16bit aligned
+    pu16MatrixMap = pu8Arena ? (uint16_t *)(pu8Arena + (size_t)u16ArenaLeds * LedStateBytesPerLed) : NULL;
+    pu8FadeFrame  = pu8Arena ? (pu8Arena + (size_t)u16ArenaLeds * (LedStateBytesPerLed + LedMapBytesPerLed)) : NULL;
+    if (u8DebugLevel & DEBUG_LED_EVENTS) {
+        char buffer[100];
+        sprintf(buffer, " Arena:%dLeds %dByte", u16ArenaLeds, (int)(u16ArenaLeds * LedArenaBytesPerLed));
+        vConsole(u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
+    }
+}
+
+//=============================================================================
+// largest LedCount: its bus (LedBusBytesPerLed) must fit into the heap next to
+// LedHeapReserve for the network stack and its effect state into the arena.
+// The buffers of the current bus are freed before a new one is created, so
+// they count as available. Without arena the effects run without state.
+uint16_t LedStripe::u16LedCountLimit() {
+    uint32_t u32Free = ESP.getFreeHeap() + (strip ? ((uint32_t)strip->PixelCount() * LedBusBytesPerLed) : 0);
+    uint32_t u32Leds = (u32Free > LedHeapReserve) ? (u32Free - LedHeapReserve) / LedBusBytesPerLed : 0;
+    uint32_t u32Max  = pu8Arena ? u16ArenaLeds : LedCountMax;
+    return (uint16_t)((u32Leds > u32Max) ? u32Max : u32Leds);
+}
+
+//=============================================================================
+bool LedStripe::boLedCountFits(uint16_t u16NewLedCount) {
+    return u16NewLedCount && (u16NewLedCount <= u16LedCountLimit());
+}
+
+//=============================================================================
+// print the heap state, to verify LedCount changes don't leak or fragment the heap
+void LedStripe::vHeapReport(const char *pcWhen) {
+    if (u8DebugLevel & DEBUG_LED_EVENTS) {
+        char buffer[100];
+        sprintf(buffer, " %s LedCount:%d FreeHeap:%lu Fragmentation:%d%% MaxFreeBlock:%lu",
+            pcWhen,
+            strip ? strip->PixelCount() : 0,
+            (unsigned long)ESP.getFreeHeap(),
+            ESP.getHeapFragmentation(),
+            (unsigned long)ESP.getMaxFreeBlockSize());
+        vConsole(u8DebugLevel, DEBUG_LED_EVENTS, CLASS_NAME, __FUNCTION__, buffer);
     }
-    strip->Show();
 }
 
 //=============================================================================
 void LedStripe::vLoop() {
     bool boUpdateWebClients = false;
 
+    vFlushFrame();        // send a pending frame as soon as the DMA is idle
+    cAnimation->vLoop();  // read ahead the animation between the frames
+    if (!cFrameTimer->boTick()) return; // next frame is not due yet
+
     if (!boDistanceSensCalibActive) {
         // when distance sensor calibration is not active
         if (boNewSwitchMode != boCurrentSwitchMode) {
             // strip will be turned on/off
-            uint8_t u8DampedBrightness = (uint8_t)cOnOffDamp->fGetDampedVal(u8NewSwitchBrightness);
-            //...................................................................
-            // manage color mode
-            switch ((tColorMode)pEep->u8ColorMode) {
-                case nMonochrome: // use the same color of all pixels, but shift the color smoothly
-                    vSetMonochrome(pEep->u16Hue, pEep->u8Saturation, u8DampedBrightness, pEep->u8Speed);
-                    break;
-                case nRainbow: // draw a rainbow and shift/move the colors
-                    vSetRainbow(pEep->u16Hue, pEep->u8Saturation, u8DampedBrightness, pEep->u8Speed);
-                    break;
-                case nRandom: // change for each pixel color individually, but smooth
-                    vSetRandom(pEep->u8Saturation, u8DampedBrightness, boInitRandomHue, pEep->u8Speed);
-                    boInitRandomHue = false;
-                    break;
-                case nMovingPoint: // change for each pixel color individually, but smooth
-                    vSetMovingPoint(pEep->u16Hue, pEep->u8Saturation, u8DampedBrightness, false);
-                    break;
-                default:
-                    break;
-            }
+            uint8_t u8DampedBrightness = (uint8_t)cOnOffDamp->i16GetDampedVal(u8NewSwitchBrightness);
+            vRender(u8DampedBrightness);
             if (boNewSwitchMode) {
                 if ((u8NewSwitchBrightness - 1) <= u8DampedBrightness) {
                     boCurrentSwitchMode = boNewSwitchMode;
                     boUpdateWebClients = true;
                 }
             } else {
-                if ((u8DampedBrightness + 1) <= pEep->u8BrightnessMin) {
+                if (!u8DampedBrightness) {
                     boCurrentSwitchMode = boNewSwitchMode;
                     strip->Begin();
-                    strip->Show();
+                    vShow(false);
                     boUpdateWebClients = true;
                 }
             }
             //if (pEep->u8Speed) boUpdateWebClients = true;
         }
         else if (   (boCurrentSwitchMode || boNewSwitchMode)
-                && pEep->u8Speed) {
-            // strip is on and an animation speed is active
-            //...................................................................
-            // manage color mode
-            switch ((tColorMode)pEep->u8ColorMode) {
-                case nMonochrome: // use the same color of all pixels, but shift the color smoothly
-                    vSetMonochrome(pEep->u16Hue, pEep->u8Saturation, u8GetBrightness(), pEep->u8Speed);
-                    //boUpdateWebClients = true;
-                    break;
-                case nRainbow: // draw a rainbow and shift/move the colors
-                    vSetRainbow(pEep->u16Hue, pEep->u8Saturation, u8GetBrightness(), pEep->u8Speed);
-                    //boUpdateWebClients = true;
-                    break;
-                case nRandom: // change for each pixel color individually, but smooth
-                    vSetRandom(pEep->u8Saturation, u8GetBrightness(), false, pEep->u8Speed);
-                    break;
-                case nMovingPoint: // change for each pixel color individually, but smooth
-                    delay((255 - pEep->u8Speed)<<1); // wait max 500ms
-                    vSetMovingPoint(pEep->u16Hue, pEep->u8Saturation, u8GetBrightness(), true);
-                    break;
-                default:
-                    break;
-            }
+                && (boAnimated() || boFading || cGammaLut.boDithering())) {
+            // strip is on and an animation speed, a crossfade or the dither of dim pixels is active
+            vRender(u8GetBrightness());
         }
         if (boUpdateWebClients && pWebServer) {
             pWebServer->vSendStripeStatus(-1, true); // update values for every web client
         }
     }
+    cFrameTimer->vFrameDone();
+
+    if (   pWebServer && (u8PowerScale != u8ReportedPowerScale)
+        && (millis() - ulPowerReportTime >= LedPowerReportTime)) {
+        // the power limiter changed the brightness
+        u8ReportedPowerScale = u8PowerScale;
+        ulPowerReportTime    = millis();
+        pWebServer->vSendPowerStatus(-1, true);
+    }
+    if (pWebServer && (millis() - ulFrameReportTime >= LedFrameReportTime)) {
+        // frames sent and skipped by the checksum, measured fps and jitter
+        ulFrameReportTime = millis();
+        pWebServer->vSendFrameStatus(-1, true);
+    }
+
+    if ((u8DebugLevel & DEBUG_LED_DETAILS) && (millis() - ulLastStatsTime >= 10000)) {
+        char buffer[100];
+        sprintf(buffer, " Fps:%d/%d Jitter:%luus RenderTime:%luus OverBudget:%lu",
+            cFrameTimer->u16GetFps(), cFrameTimer->u8GetTargetFps(), cFrameTimer->ulGetJitter(),
+            cFrameTimer->ulGetFrameTime(), (unsigned long)cFrameTimer->u32GetOverBudget());
+        vConsole(u8DebugLevel, DEBUG_LED_DETAILS, CLASS_NAME, __FUNCTION__, buffer);
+        sprintf(buffer, " Frames sent:%lu skipped:%lu SentFps:%lu DmaWait:%luus",
+            (unsigned long)u32FramesSent, (unsigned long)u32FramesSkipped,
+            (unsigned long)((u32FramesSent - u32StatsFramesSent) * 1000UL / (millis() - ulLastStatsTime)),
+            ulMaxDmaWaitTime);
+        vConsole(u8DebugLevel, DEBUG_LED_DETAILS, CLASS_NAME, __FUNCTION__, buffer);
+        ulLastStatsTime    = millis();
+        u32StatsFramesSent = u32FramesSent;
+        ulMaxDmaWaitTime   = 0;
+    }
+}
+
+//=============================================================================
+// Send the pixel buffer only when the frame differs from the last sent one.
+// A FNV-1a checksum over the pixel buffer (3 bytes per LED) is much cheaper
+// than the WS2812 transmission (~30us per LED).
+void LedStripe::vShow(bool boForce) {
+    const uint8_t *pu8Pixel = strip->Pixels();
+    const uint8_t *pu8End   = pu8Pixel + strip->PixelsSize();
+    uint32_t u32Checksum    = 2166136261UL; // FNV offset basis
+
+    while (pu8Pixel < pu8End) {
+        u32Checksum = (u32Checksum ^ *pu8Pixel++) * 16777619UL; // FNV prime
+    }
+    if (!boForce && (u32Checksum == u32LastFrameChecksum)) {
+        u32FramesSkipped++;
+    } else {
+        u32LastFrameChecksum = u32Checksum;
+        if (!boFramePending) ulFramePendingTime = micros();
+        boFramePending = true;
+        vFlushFrame();
+    }
+}
+
+//=============================================================================
+// The pixel buffer is the back buffer: the ESP8266 DMA method clocks out its
+// own I2S buffer, so the next frame can be rendered while the last one is
+// still sent. Show() is only called when the DMA is idle (CanShow), otherwise
+// the frame stays pending and is sent by a later vLoop() call. Rendering a new
+// frame in between simply replaces the pending one.
+void LedStripe::vFlushFrame() {
+    if (!boFramePending || !strip->CanShow()) return; // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#bool-canshow
+
+    unsigned long ulWaitTime = micros() - ulFramePendingTime;
+    if (ulWaitTime > ulMaxDmaWaitTime) ulMaxDmaWaitTime = ulWaitTime;
+    boFramePending = false;
+    u32FramesSent++;
+    strip->Show(); // see: https://github.com/Makuna/NeoPixelBus/wiki/NeoPixelBus-object-API#void-showbool-maintainbufferconsistency--true
+}
+
+//=============================================================================
+uint32_t LedStripe::u32GetFramesSent() {
+    return u32FramesSent;
+}
+
+//=============================================================================
+uint32_t LedStripe::u32GetFramesSkipped() {
+    return u32FramesSkipped;
+}
+
+//=============================================================================
+void LedStripe::vSetFrameRate(uint8_t u8NewFps) {
+    pEep->vSetFrameRate(u8NewFps, true);
+    cFrameTimer->vSetFps(pEep->u8FrameRate); // clamped by the EEP
+}
+
+//=============================================================================
+uint16_t LedStripe::u16GetFps() {
+    return cFrameTimer->u16GetFps();
+}
+
+//=============================================================================
+unsigned long LedStripe::ulGetFrameJitter() {
+    return cFrameTimer->ulGetJitter();
+}
+
+//=============================================================================
+// per stripe white balance, folded into the brightness/gamma tables
+void LedStripe::vSetColorBalance(uint8_t u8Red, uint8_t u8Green, uint8_t u8Blue) {
+    pEep->vSetColorBalance(u8Red, u8Green, u8Blue, true);
+    cGammaLut.vSetColorBalance(pEep->u8BalanceRed, pEep->u8BalanceGreen, pEep->u8BalanceBlue);
+    vSetColor(-1); // apply the new balance at once
 }
 
 //=============================================================================
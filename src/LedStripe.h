@@ -1,6 +1,11 @@
 #ifndef LedStripe_h
 #define LedStripe_h
 #include "PT1.h"
+#include "FrameTimer.h"
+#include "GammaLut.h"
+#include "Effects.h"
+#include "Palettes.h"
+#include "Animation.h"
 #include "Eep.h"
 #include "WebServer.h"
 #include "NtpTime.h"
@@ -12,12 +17,27 @@
  #include <avr/power.h> // Required for 16 MHz Adafruit Trinket
 #endif
 
-enum tColorMode {
-    nMonochrome = 0,
-    nRainbow,
-    nRandom,
-    nMovingPoint,
-    nNoMode
+#define LedCountMax         1000  // max. supported LEDs
+#define LedCountDefault     300   // fallback, when the configured LedCount doesn't fit into the heap
+#define LedBusBytesPerLed   15    // NeoPixelBus ESP8266 DMA: 3 byte pixel buffer + 12 byte I2S buffer
+#define LedStateBytesPerLed 4     // per LED state of the active effect (rainbow hue offset or random hue and target)
+#define LedMapBytesPerLed   2     // matrix position -> LED index
+#define LedFadeBytesPerLed  3     // outgoing frame of a crossfade
+#define LedDitherBytesPerLed GammaLutDitherBytes // dither remainders of the last frame
+#define LedArenaBytesPerLed (LedStateBytesPerLed + LedMapBytesPerLed + LedFadeBytesPerLed + LedDitherBytesPerLed)
+#define LedFadeTimeDefault  500   // crossfade time between colors and modes [ms]
+#define LedOnOffTau         150   // time constant of the smooth on/off [ms]
+#define LedHeapReserve      12288 // free heap kept for WiFi, web server and MQTT [byte]
+#define LedMilliAmpPerChannel 20  // WS2812B current of one color channel at 255 [mA]
+#define LedMilliAmpIdle     1     // WS2812B current of a dark LED [mA]
+#define LedPowerReportTime  1000  // min. time between two power scale reports to the web clients [ms]
+#define LedFrameReportTime  5000  // time between two frame statistics reports to the web clients [ms]
+
+// runtime state of one segment (or the whole stripe without segments)
+struct tSegmentRun {
+    tColorMode   enActiveEffect;  // effect, which state is initialized
+    uint32_t     u32HueRemainder; // hue shift below one hue unit [1/1000]
+    tEffectState stState;
 };
 
 class LedStripe {
@@ -26,31 +46,85 @@ class LedStripe {
         void vInit(class Eep *, class NtpTime *);
         void vTurn(bool, bool);
         void vSetMonochrome(uint16_t, uint8_t, uint8_t, uint8_t);
-        void vSetRainbow(uint16_t, uint8_t, uint8_t, uint8_t);
-        void vSetRandom(uint8_t, uint8_t, bool, uint8_t);
-        void vSetMovingPoint(uint16_t, uint8_t, uint8_t, bool);
         void vSetValues(uint16_t, uint8_t, uint8_t);
         void vSetWebServer(class WebServer *);
         bool boGetSwitchStatus();
         void vSetColorMode(tColorMode, uint8_t);
+        void vSetPalette(uint8_t, uint8_t); // tPalette, client number
         void vSetColor(uint8_t);
         void vSetDistanceCalibrationActive(bool);
         void vLoop();
         void vUpdateDayLight();
         uint8_t u8GetBrightness();
+        uint32_t u32GetFramesSent();      // frames transmitted to the stripe
+        uint32_t u32GetFramesSkipped();   // frames not transmitted, because nothing changed
+        void vSetFrameRate(uint8_t);      // store and set the target animation frame rate [1/s]
+        uint16_t u16GetFps();             // measured frame rate [1/s]
+        unsigned long ulGetFrameJitter(); // measured frame jitter [us]
+        void vSetColorBalance(uint8_t, uint8_t, uint8_t); // store and set the R,G,B correction (1..255, 255:none)
+        bool boLedCountFits(uint16_t);    // true, when the bus of this LedCount fits into the heap and its effect state into the arena
+        void vSetFadeTime(uint16_t);      // crossfade time between colors and modes [ms], 0: switch at once
+        bool boSetSegment(uint8_t, const tSegment &); // check and store a segment, false: invalid
+        void vSetSegmentCount(uint8_t);   // number of used segments, 0: whole stripe with the global values
+        bool boSetMatrix(uint8_t, uint8_t, uint8_t); // width, height, tMatrixLayout (0,0: linear), false: invalid
+        void vSetPowerBudget(uint16_t);   // max. current of the stripe [mA], 0: unlimited
+        uint8_t u8GetPowerScale();        // brightness scale of the last frame by the power budget (255: not limited)
+        void vAnimationUpload(bool);      // true: a new animation file is written, false: upload done
 
     private:
+        void vShow(bool);
+        void vFlushFrame();
+        void vRender(uint8_t);
+        unsigned long ulPrepareFrame(uint8_t, tEffectParams &);
+        void vRenderSegment(tSegmentRun &, tSegment &, tEffectParams &, unsigned long);
+        void vFinishFrame(unsigned long, uint32_t);
+        void vLimitPower(uint32_t);
+        void vResetEffects();
+        void vReleaseAnimation();
+        bool boAnimated();
+        void vStartFade();
+        void vBlendFrame(unsigned long, uint32_t &);
+        void vHeapReport(const char *);
+        void vAllocArena();
+        uint16_t u16LedCountLimit();
+        void vBuildMatrixMap();
         class Eep       *pEep;
         class NtpTime   *pNtpTime;
         class WebServer *pWebServer;
-        NeoPixelBus<NeoGrbFeature, Neo800KbpsMethod> *strip;
-        NeoGamma<NeoGammaTableMethod> colorGamma;
-        PT1 *cOnOffDamp = new PT1(10, 150);
+        tNeoStripe *strip = NULL;
+        alignas(tNeoStripe) uint8_t au8StripeMem[sizeof(tNeoStripe)]; // storage of *strip
+        uint8_t *pu8Arena = NULL; // per LED effect state, matrix map, crossfade frame and dither remainders (u16ArenaLeds * LedArenaBytesPerLed)
+        GammaLut cGammaLut;
+        Animation *cAnimation = NULL;
+        PT1 *cOnOffDamp = new PT1(LedOnOffTau);
+        FrameTimer *cFrameTimer = new FrameTimer(FrameTimerFpsDefault);
         uint8_t  u8DebugLevel              = 0;
         bool     boCurrentSwitchMode       = false;
         bool     boNewSwitchMode           = false;
-        bool     boInitRandomHue           = false;
         bool     boDistanceSensCalibActive = false;
         uint8_t u8NewSwitchBrightness      = 0;
+        uint32_t u32LastFrameChecksum      = 0;
+        uint32_t u32FramesSent             = 0;
+        uint32_t u32FramesSkipped          = 0;
+        unsigned long ulLastStatsTime      = 0;
+        uint32_t u32StatsFramesSent        = 0;
+        bool     boFramePending            = false; // rendered frame waits for the DMA
+        unsigned long ulFramePendingTime   = 0;     // [us]
+        unsigned long ulMaxDmaWaitTime     = 0;     // [us]
+        uint16_t u16ArenaLeds              = 0;       // LEDs of pu8Arena (max. LedCount)
+        unsigned long ulLastRenderTime     = 0;       // [ms]
+        uint8_t *pu8FadeFrame              = NULL;    // outgoing frame in pu8Arena
+        uint16_t *pu16MatrixMap            = NULL;    // matrix index (y * width + x) -> LED in pu8Arena
+        uint16_t u16MatrixLeds             = 0;       // LEDs of the built map, 0: linear stripe
+        RgbColor aPalette[PaletteSize];               // expanded palette of the palette effects
+        uint8_t  u8ActivePalette           = nNoPalette; // palette in aPalette
+        uint8_t  u8PowerScale              = 0xff;    // scale of the last frame (255: not limited)
+        uint8_t  u8ReportedPowerScale      = 0xff;    // scale of the last report to the web clients
+        unsigned long ulPowerReportTime    = 0;       // [ms]
+        unsigned long ulFrameReportTime    = 0;       // [ms]
+        uint16_t u16FadeTime               = LedFadeTimeDefault; // [ms]
+        bool     boFading                  = false;   // crossfade is running
+        unsigned long ulFadeStartTime      = 0;       // [ms]
+        tSegmentRun astRuns[SegmentsMax]; // runtime state of the segments, [0]: whole stripe
 };
 #endif
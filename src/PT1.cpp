@@ -1,23 +1,59 @@
 #include "PT1.h"
 
+// exp(-n), n = 0..PT1ExpMax-1 [1/65536]
+static const uint32_t au32ExpInt[PT1ExpMax] = {
+    65536, 24109, 8869, 3263, 1200, 442, 162, 60, 22, 8, 3, 1
+};
+
+// exp(-n/16), n = 0..15 [1/65536]
+static const uint32_t au32ExpSixteenth[16] = {
+    65536, 61565, 57835, 54331, 51039, 47947, 45042, 42313,
+    39750, 37341, 35079, 32954, 30957, 29081, 27319, 25664
+};
+
+//=======================================================================
+PT1::PT1(uint16_t u16NewTau) {
+    u16Tau = u16NewTau;
+}
+
 //=======================================================================
-PT1::PT1(unsigned long ulNewPeriode, unsigned long ulNewTau) {
-    ulPeriode = ulNewPeriode;
-    ulTau     = ulNewTau;
+void PT1::vSetTau(uint16_t u16NewTau) {
+    u16Tau = u16NewTau;
 }
 
 //=======================================================================
-void PT1::vInitDampVal(float fNewDampVal) {
-    fDampedValue = fNewDampVal;
+void PT1::vInitDampVal(int16_t i16NewDampVal) {
+    i32DampedValue = (int32_t)i16NewDampVal << PT1FracBits;
+    ulLastRun      = millis();
 }
 
 //=======================================================================
-float PT1::fGetDampedVal(int iNewVal) {
-    unsigned long FF = ulTau / ulPeriode;
-    if (millis() - ulLastRun < ulPeriode)
-        return fDampedValue;
-    ulLastRun = millis();
-    fDampedValue = (((fDampedValue * FF) + iNewVal) / (FF + 1));
-
-    return fDampedValue;
-}
\ No newline at end of file
+// exp(-r) = exp(-integer) * exp(-sixteenths) * exp(-rest), the rest is
+// below 1/16 and covered by 1 - g + g^2/2
+uint32_t PT1::u32ExpNeg(uint32_t u32Ratio) {
+    uint32_t u32Int = u32Ratio >> 16;
+    if (u32Int >= PT1ExpMax) return 0;
+    uint32_t u32Rest = u32Ratio & 0x0fff;                                      // g < 1/16 [1/65536]
+    uint32_t u32Exp  = 65536 - u32Rest + ((u32Rest * u32Rest) >> 17);          // exp(-g)
+    u32Exp = (uint32_t)(((uint64_t)u32Exp * au32ExpSixteenth[(u32Ratio >> 12) & 0x0f]) >> 16);
+    return (uint32_t)(((uint64_t)u32Exp * au32ExpInt[u32Int]) >> 16);
+}
+
+//=======================================================================
+int16_t PT1::i16GetDampedVal(int16_t i16NewVal) {
+    unsigned long ulNow   = millis();
+    unsigned long ulDelta = ulNow - ulLastRun;
+    int32_t i32Target     = (int32_t)i16NewVal << PT1FracBits;
+
+    if (!u16Tau || (ulDelta >= (unsigned long)u16Tau * PT1ExpMax)) {
+        // no damping or the input was reached long ago
+        i32DampedValue = i32Target;
+        ulLastRun      = ulNow;
+    } else if (ulDelta) {
+        // dt / tau < PT1ExpMax, the ratio fits into 32 bit
+        uint32_t u32Decay = u32ExpNeg((uint32_t)(((uint64_t)ulDelta << 16) / u16Tau));
+        i32DampedValue += (int32_t)(((int64_t)(i32Target - i32DampedValue) * (int32_t)(65536 - u32Decay)) >> 16);
+        ulLastRun       = ulNow;
+    }
+    return (int16_t)((i32DampedValue + (1L << (PT1FracBits - 1))) >> PT1FracBits);
+}
@@ -2,17 +2,25 @@
 #define PT1_h
 #include <Arduino.h>
 
+#define PT1FracBits 16 // fixed point fraction of the damped value
+#define PT1ExpMax   12 // dt >= 12 * tau: exp(-dt/tau) is below 1/65536, the output is the input
+
+// First order lag in fixed point: y += (x - y) * (1 - exp(-dt/tau)) with the
+// real time dt since the last call, so the damping is independent of the
+// loop rate and late calls don't lose steps. The exponential comes from two
+// small tables and a second order term (error < 1/65536).
 class PT1 {
     public:
-        PT1(unsigned long, unsigned long);
-        void vInitDampVal(float);
-        float fGetDampedVal(int);
+        PT1(uint16_t);                    // time constant [ms]
+        void vSetTau(uint16_t);           // time constant [ms], 0: no damping
+        void vInitDampVal(int16_t);       // set the output, the time starts now
+        int16_t i16GetDampedVal(int16_t); // follow the input by the time since the last call
+        static uint32_t u32ExpNeg(uint32_t); // exp(-r), r and the result [1/65536]
 
     private:
-        float         fDampedValue;
-        unsigned long ulLastRun;
-        unsigned long ulPeriode;
-        unsigned long ulTau;
+        int32_t       i32DampedValue = 0; // [1/65536]
+        unsigned long ulLastRun      = 0; // [ms]
+        uint16_t      u16Tau         = 0; // [ms]
 };
 
 #endif
@@ -0,0 +1,63 @@
+#include "Palettes.h"
+
+// gradients, see: http://soliton.vm.bytemark.co.uk/pub/cpt-city/ for more
+static const tGradientStop astRainbowStops[] PROGMEM = {
+    {  0, 255,   0,   0}, { 43, 255, 255,   0}, { 85,   0, 255,   0},
+    {128,   0, 255, 255}, {170,   0,   0, 255}, {213, 255,   0, 255},
+    {255, 255,   0,   0}
+};
+static const tGradientStop astOceanStops[] PROGMEM = {
+    {  0,   0,   0,  64}, { 64,   0,  32, 160}, {128,   0, 128, 192},
+    {192,  64, 224, 224}, {255,   0,   0,  64}
+};
+static const tGradientStop astLavaStops[] PROGMEM = {
+    {  0,   0,   0,   0}, { 64, 128,   0,   0}, {128, 255,  32,   0},
+    {192, 255, 160,   0}, {224, 255, 255, 128}, {255,   0,   0,   0}
+};
+static const tGradientStop astForestStops[] PROGMEM = {
+    {  0,   0,  48,   0}, { 80,  32, 128,   0}, {160, 128, 160,   0},
+    {208,  16,  96,  16}, {255,   0,  48,   0}
+};
+static const tGradientStop astPartyStops[] PROGMEM = {
+    {  0,  85,   0, 171}, { 48, 171,   0,  85}, { 96, 255,  64,   0},
+    {144, 255, 192,   0}, {192, 171,   0,  85}, {255,  85,   0, 171}
+};
+static const tGradientStop astSunsetStops[] PROGMEM = {
+    {  0, 120,   0,   0}, { 64, 255, 64,    0}, {112, 255, 160,  16},
+    {160, 160,   0,  64}, {208,  32,   0,  96}, {255, 120,   0,   0}
+};
+
+const tPaletteDef astPalettes[nNoPalette] = {
+    {"Rainbow", astRainbowStops},
+    {"Ocean",   astOceanStops},
+    {"Lava",    astLavaStops},
+    {"Forest",  astForestStops},
+    {"Party",   astPartyStops},
+    {"Sunset",  astSunsetStops}
+};
+
+//=============================================================================
+// Sample the gradient at the PaletteSize positions (entry * 256 / PaletteSize)
+// with an integer lerp between the two surrounding stops.
+void vExpandPalette(uint8_t u8Palette, RgbColor *pPalette) {
+    if (u8Palette >= nNoPalette) u8Palette = nPaletteRainbow;
+    const tGradientStop *pstStop = astPalettes[u8Palette].pstStops;
+
+    tGradientStop stLow, stHigh;
+    memcpy_P(&stLow, pstStop, sizeof(tGradientStop));
+    memcpy_P(&stHigh, pstStop, sizeof(tGradientStop));
+    for (uint8_t u8Idx = 0; u8Idx < PaletteSize; u8Idx++) {
+        uint8_t u8Pos = u8Idx * (256 / PaletteSize);
+        while (stHigh.u8Pos < u8Pos) {
+            // next pair of stops, the last stop is at 255
+            stLow = stHigh;
+            memcpy_P(&stHigh, ++pstStop, sizeof(tGradientStop));
+        }
+        uint16_t u16Range = stHigh.u8Pos - stLow.u8Pos;
+        int16_t  i16Frac  = u16Range ? (int16_t)(((uint16_t)(u8Pos - stLow.u8Pos) << 8) / u16Range) : 0; // 0..256
+        pPalette[u8Idx] = RgbColor(
+            (uint8_t)(stLow.u8Red   + (((stHigh.u8Red   - stLow.u8Red)   * i16Frac) >> 8)),
+            (uint8_t)(stLow.u8Green + (((stHigh.u8Green - stLow.u8Green) * i16Frac) >> 8)),
+            (uint8_t)(stLow.u8Blue  + (((stHigh.u8Blue  - stLow.u8Blue)  * i16Frac) >> 8)));
+    }
+}
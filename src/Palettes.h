@@ -0,0 +1,50 @@
+#ifndef Palettes_h
+#define Palettes_h
+#include <Arduino.h>
+#include <NeoPixelBus.h> // see: https://github.com/Makuna/NeoPixelBus
+
+#define PaletteSize 16 // entries of an expanded palette, the position steps are 0x1000
+
+enum tPalette {
+    nPaletteRainbow = 0,
+    nPaletteOcean,
+    nPaletteLava,
+    nPaletteForest,
+    nPaletteParty,
+    nPaletteSunset,
+    nNoPalette
+};
+
+// one color of a gradient, the gradients are in the flash (PROGMEM)
+struct tGradientStop {
+    uint8_t u8Pos;   // 0..255, the last stop of a gradient is at 255
+    uint8_t u8Red;
+    uint8_t u8Green;
+    uint8_t u8Blue;
+};
+
+struct tPaletteDef {
+    const char          *pcName;
+    const tGradientStop *pstStops; // PROGMEM
+};
+
+extern const tPaletteDef astPalettes[nNoPalette]; // index: tPalette
+
+// gradient of the flash -> PaletteSize entries in the RAM, once per palette change
+void vExpandPalette(uint8_t, RgbColor *);
+
+// Color of the position (0..0xffff, full circle) with the 8 bit interpolation
+// between two palette entries, scaled by u8Value (0..255). No HSB math per pixel.
+inline RgbColor rgbPaletteColor(const RgbColor *pPalette, uint16_t u16Pos, uint8_t u8Value) {
+    uint8_t  u8Idx     = (uint8_t)(u16Pos >> 12);
+    int16_t  i16Frac   = (uint8_t)(u16Pos >> 4);
+    uint16_t u16Scale  = (uint16_t)u8Value + 1;
+    const RgbColor &rgbA = pPalette[u8Idx];
+    const RgbColor &rgbB = pPalette[(u8Idx + 1) & (PaletteSize - 1)];
+    return RgbColor(
+        (uint8_t)(((uint8_t)(rgbA.R + (((rgbB.R - rgbA.R) * i16Frac) >> 8)) * u16Scale) >> 8),
+        (uint8_t)(((uint8_t)(rgbA.G + (((rgbB.G - rgbA.G) * i16Frac) >> 8)) * u16Scale) >> 8),
+        (uint8_t)(((uint8_t)(rgbA.B + (((rgbB.B - rgbA.B) * i16Frac) >> 8)) * u16Scale) >> 8));
+}
+
+#endif
@@ -0,0 +1,19 @@
+#include "Random.h"
+
+uint32_t u32RandomState = RandomSeedFixed;
+
+//=============================================================================
+// Each boot gets its own sequence, except in test builds, where the effect
+// output must be the same on every run (golden tests on the host).
+void vRandomInit() {
+#ifdef RANDOM_FIXED_SEED
+    vRandomSeed(RandomSeedFixed);
+#else
+    vRandomSeed(ESP.random()); // see: https://arduino-esp8266.readthedocs.io/en/latest/libraries.html#esp-specific-apis
+#endif
+}
+
+//=============================================================================
+void vRandomSeed(uint32_t u32Seed) {
+    u32RandomState = u32Seed ? u32Seed : RandomSeedFixed;
+}
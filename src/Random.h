@@ -0,0 +1,28 @@
+#ifndef Random_h
+#define Random_h
+#include <Arduino.h>
+
+#define RandomSeedFixed 0x2545f491UL // seed of the test builds (build flag -D RANDOM_FIXED_SEED)
+
+// xorshift32 PRNG shared by all effects, see: https://www.jstatsoft.org/article/view/v008i14
+// One shift/xor sequence per number instead of the Arduino random() with its
+// modulo. Not for anything security related.
+extern uint32_t u32RandomState;
+
+void vRandomInit();          // seed from the hardware RNG, fixed with RANDOM_FIXED_SEED
+void vRandomSeed(uint32_t);  // restart the sequence (0 is replaced, xorshift must not be 0)
+
+inline uint32_t u32Random() {
+    uint32_t u32X = u32RandomState;
+    u32X ^= u32X << 13;
+    u32X ^= u32X >> 17;
+    u32X ^= u32X << 5;
+    return u32RandomState = u32X;
+}
+
+// 0..0xffff, the upper bits of xorshift are the better ones
+inline uint16_t u16Random() {
+    return (uint16_t)(u32Random() >> 16);
+}
+
+#endif
@@ -91,6 +91,31 @@ void WebServer::vInit(
         request->send(SPIFFS, "/wheelcolorpicker.css", "text/css");
         if (u8DebugLevel & DEBUG_WEBSERVER_EVENTS) Serial.printf("[%s::%s] request: /wheelcolorpicker.css\n", CLASS_NAME, "HTTP_GET");
     });
+    pWebServer->on("/animation", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (boUploadFailed) {
+            request->send(507, "text/plain", "The animation doesn't fit into the SPIFFS");
+        } else {
+            request->send(200, "text/plain", "OK");
+        }
+        if (u8DebugLevel & DEBUG_WEBSERVER_EVENTS) Serial.printf("[%s::%s] request: /animation\n", CLASS_NAME, "HTTP_POST");
+    }, std::bind(&WebServer::vAnimationUpload, this, _1, _2, _3, _4, _5, _6));
+    // stored configuration (EEP values without the WiFi password)
+    pWebServer->on("/config.json", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        JsonDocument doc;
+        pEep->vExport(doc.to<JsonObject>());
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        serializeJson(doc, *response);
+        request->send(response);
+        if (u8DebugLevel & DEBUG_WEBSERVER_EVENTS) Serial.printf("[%s::%s] request: /config.json\n", CLASS_NAME, "HTTP_GET");
+    });
+    pWebServer->on("/config.msgpack", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        JsonDocument doc;
+        pEep->vExport(doc.to<JsonObject>());
+        AsyncResponseStream *response = request->beginResponseStream("application/msgpack");
+        serializeMsgPack(doc, *response);
+        request->send(response);
+        if (u8DebugLevel & DEBUG_WEBSERVER_EVENTS) Serial.printf("[%s::%s] request: /config.msgpack\n", CLASS_NAME, "HTTP_GET");
+    });
 
     // Start pWebServer
     pWebServer->begin();
@@ -104,6 +129,62 @@ void WebServer::vInit(
     //vSendInitValues(-1, true);            // update values for every client
 }
 
+//=======================================================================
+// Callback: one part of the uploaded animation file, it's written directly
+// into the SPIFFS, the playback is stopped until the file is complete. An
+// upload, which doesn't fit into the SPIFFS, is refused before the old file
+// is touched.
+void WebServer::vAnimationUpload(
+    AsyncWebServerRequest *request,
+    const String &filename,
+    size_t index,
+    uint8_t *data,
+    size_t len,
+    bool final)
+{
+    if (!index) {
+        boUploadFailed = !boAnimationFits(request->contentLength());
+        if (u8DebugLevel & DEBUG_WEBSERVER_EVENTS) Serial.printf("[%s::%s] %s -> %s %s\n", CLASS_NAME, __FUNCTION__, filename.c_str(), AnimationFileName, boUploadFailed ? "doesn't fit" : "");
+        if (boUploadFailed) return;
+        pLedStripe->vAnimationUpload(true);
+        fileUpload = SPIFFS.open(AnimationFileName, "w");
+        request->onDisconnect([this]() { vAnimationUploadEnd(false); }); // the client may abort the upload
+    }
+    if (fileUpload && len && (fileUpload.write(data, len) != len)) {
+        if (u8DebugLevel & DEBUG_WEBSERVER_EVENTS) Serial.printf("[%s::%s] write error at %d byte\n", CLASS_NAME, __FUNCTION__, (int)index);
+        boUploadFailed = true;
+        vAnimationUploadEnd(false);
+    }
+    if (final && fileUpload) {
+        if (u8DebugLevel & DEBUG_WEBSERVER_EVENTS) Serial.printf("[%s::%s] %d byte\n", CLASS_NAME, __FUNCTION__, (int)(index + len));
+        vAnimationUploadEnd(true);
+    }
+}
+
+//=======================================================================
+// end of a complete, aborted or failed upload, an incomplete file is removed,
+// the playback continues in any case
+void WebServer::vAnimationUploadEnd(bool boComplete) {
+    if (!fileUpload) return; // not started or already ended
+    fileUpload.close();
+    if (!boComplete) SPIFFS.remove(AnimationFileName);
+    pLedStripe->vAnimationUpload(false);
+}
+
+//=======================================================================
+// the new file replaces the old one, so the space of the old one is free too
+bool WebServer::boAnimationFits(size_t sizeUpload) {
+    FSInfo fsInfo;
+    if (!SPIFFS.info(fsInfo)) return false;
+    size_t sizeFree = fsInfo.totalBytes - fsInfo.usedBytes;
+    File fileOld = SPIFFS.open(AnimationFileName, "r");
+    if (fileOld) {
+        sizeFree += fileOld.size();
+        fileOld.close();
+    }
+    return sizeUpload <= sizeFree;
+}
+
 //=======================================================================
 void WebServer::vSetIp(IPAddress newLocalIP) {
     localIP = newLocalIP; // store the current IP
@@ -143,6 +224,10 @@ String WebServer::sTemplateProcessor(const String &var) {
         snprintf(buffer, 50, "%d", pEep->u8ColorMode);
     } else if (var == "speed") {
         snprintf(buffer, 50, "%d", pEep->u8Speed);
+    } else if (var == "palette") {
+        snprintf(buffer, 50, "%d", pEep->u8Palette);
+    } else if (var == "powerBudget") {
+        snprintf(buffer, 50, "%d", pEep->u16PowerBudget);
     } else if (var == "wsUrl") {
         snprintf(buffer, 50, "ws://%d.%d.%d.%d:%d/", localIP[0], localIP[1], localIP[2], localIP[3], iWebSocketPort);
     }
@@ -216,7 +301,9 @@ void WebServer::vWebSocketEvent(uint8_t clientNumber,
                 int start = sPayload.indexOf("ledCount:") + 9;
                 int end = sPayload.indexOf("bMin:");
                 uint16_t u16NewLedCount = (uint16_t)sPayload.substring(start, end).toInt(); // get the new value
-                pEep->vSetLedCount(u16NewLedCount, true); // store the new value in EEP
+                if (pLedStripe->boLedCountFits(u16NewLedCount)) {
+                    pEep->vSetLedCount(u16NewLedCount, true); // store the new value in EEP
+                }                                            // else keep the current LedCount, the client gets it with the status update
 
                 start = sPayload.indexOf("bMin:") + 5;
                 end   = sPayload.indexOf("bMax:");
@@ -266,6 +353,7 @@ void WebServer::vWebSocketEvent(uint8_t clientNumber,
 
                 pEep->vSetWifiSsidPwd(acWifiSsid, acWifiPwd, true);
                 pEep->vSetWiFiMode(0, true); // on next Reset start SSID mode
+                pEep->vFlush();
                 ESP.restart(); // reset
             } else if (strstr((char *)payload, "factoryReset")) {
                 pEep->vFactoryReset();
@@ -286,6 +374,21 @@ void WebServer::vWebSocketEvent(uint8_t clientNumber,
                 int end         = sPayload.length();
                 pLedStripe->vSetColorMode((tColorMode)sPayload.substring(start, end).toInt(), clientNumber);
                 vSendColorMode(clientNumber, true);
+            } else if (strstr((char *)payload, "powerBudget")) {
+                // power budget changed via web page
+                String sPayload = String((char *)payload);
+                int start       = sPayload.indexOf("powerBudget:") + 12;
+                int end         = sPayload.length();
+                long lNewBudget = sPayload.substring(start, end).toInt();
+                pLedStripe->vSetPowerBudget((lNewBudget > 0) && (lNewBudget < 0xffff) ? (uint16_t)lNewBudget : 0);
+                vSendPowerStatus(clientNumber, true);
+            } else if (strstr((char *)payload, "palette")) {
+                // palette changed via web page
+                String sPayload = String((char *)payload);
+                int start       = sPayload.indexOf("palette:") + 8;
+                int end         = sPayload.length();
+                pLedStripe->vSetPalette((uint8_t)sPayload.substring(start, end).toInt(), clientNumber);
+                vSendColorMode(clientNumber, true);
             } else if (strstr((char *)payload, "speed")) {
                 // speed changed via web page
                 String sPayload = String((char *)payload);
@@ -468,9 +571,27 @@ void WebServer::vSendColorMode(int clientNumber, bool boToAllClients) {
     char msg_buf[100];
 
     // get the current stripe status
-    sprintf(msg_buf, "colorMode:%dspeed:%d",
+    sprintf(msg_buf, "colorMode:%dspeed:%dpalette:%d",
             pEep->u8ColorMode,
-            pEep->u8Speed);
+            pEep->u8Speed,
+            pEep->u8Palette);
+    if (boToAllClients) {
+        // send to all clients expect the selected one
+        vSendBufferToAllClients(msg_buf, clientNumber);
+    } else {
+        // send only to the selected client
+        vSendBufferToOneClient(msg_buf, clientNumber);
+    }
+}
+
+//=======================================================================
+// send the power budget and the scale of the power limiter [%] to all active clients
+void WebServer::vSendPowerStatus(int clientNumber, bool boToAllClients) {
+    char msg_buf[100];
+
+    sprintf(msg_buf, "powerBudget:%dpowerScale:%d",
+            pEep->u16PowerBudget,
+            (pLedStripe->u8GetPowerScale() * 100 + 127) / 255);
     if (boToAllClients) {
         // send to all clients expect the selected one
         vSendBufferToAllClients(msg_buf, clientNumber);
@@ -570,6 +691,25 @@ void WebServer::vSendBufferToOneClient(char *msg_buf,int clientNumber) {
     }
 }
 
+//=======================================================================
+// send the frame statistics of the stripe (frames, measured fps and jitter [us]) to all active clients
+void WebServer::vSendFrameStatus(int clientNumber, bool boToAllClients) {
+    char msg_buf[100];
+
+    sprintf(msg_buf, "framesSent:%luframesSkipped:%lufps:%djitter:%lu",
+            (unsigned long)pLedStripe->u32GetFramesSent(),
+            (unsigned long)pLedStripe->u32GetFramesSkipped(),
+            pLedStripe->u16GetFps(),
+            pLedStripe->ulGetFrameJitter());
+    if (boToAllClients) {
+        // send to all clients expect the selected one
+        vSendBufferToAllClients(msg_buf, clientNumber);
+    } else {
+        // send only to the selected client
+        vSendBufferToOneClient(msg_buf, clientNumber);
+    }
+}
+
 //=======================================================================
 // send init values to the selected clients
 void WebServer::vSendInitValues(int clientNumber, bool boToAllClients) {
@@ -580,4 +720,6 @@ void WebServer::vSendInitValues(int clientNumber, bool boToAllClients) {
     vSendTimeSetup(clientNumber, boToAllClients);             // update time setup for every client
     vSendSunData(clientNumber, boToAllClients);               // update sun data for every client
     vSendPowerOnRestoreSwitch(clientNumber, boToAllClients);  // update PowerOnRestoreSwitch for every client
+    vSendPowerStatus(clientNumber, boToAllClients);           // update power budget and limiter for every client
+    vSendFrameStatus(clientNumber, boToAllClients);           // update frame statistics for every client
 }
@@ -28,6 +28,8 @@ class WebServer {
         void vSendStripeStatus(int, bool);
         void vSendSunData(int, bool);
         void vSendColorMode(int, bool);
+        void vSendPowerStatus(int, bool);
+        void vSendFrameStatus(int, bool);
 
     private:
         void vWebSocketEvent(uint8_t, WStype_t, uint8_t *, size_t);
@@ -38,6 +40,9 @@ class WebServer {
         void vSendBufferToOneClient(char *, int);
         void vSendInitValues(int , bool);
         void vSendPowerOnRestoreSwitch(int, bool);
+        void vAnimationUpload(AsyncWebServerRequest *, const String &, size_t, uint8_t *, size_t, bool);
+        void vAnimationUploadEnd(bool);
+        bool boAnimationFits(size_t);
 
         class Eep *pEep;
         class LedStripe *pLedStripe;
@@ -47,6 +52,8 @@ class WebServer {
         AsyncWebServer *pWebServer;
         WebSocketsServer *pWebSocket;
         IPAddress localIP;
+        File fileUpload;                 // animation file during an upload
+        bool boUploadFailed = false;     // the last upload didn't fit into the SPIFFS or wasn't written
         int iWebSocketPort;
 };
 
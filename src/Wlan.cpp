@@ -193,6 +193,7 @@ void Wlan::vLoop(){
                 if ((millis() - ulSSIDinitLinkTimeout) > CONNECTION_TIMEOUT_SSID) {
                     // start WiFi AP mode
                     pEep->vSetWiFiMode(1, true); // after Reset start AP mode
+                    pEep->vFlush();
                     ESP.restart();               // reset
                 }
             }
@@ -20,6 +20,7 @@
 #include "Utils.h"      // useful utils
 #include "DebugLevel.h" // debug level definiton
 #include "NtpTime.h"    // NTP time
+#include "Random.h"     // effect PRNG
 
 #define mqttSendCyclicInterval 60000 * 5 // send values cyclic every 5min
 #define mqttReconnectInterval   1000 * 5 // mqtt reconnect interval 5sec
@@ -103,6 +104,14 @@ void vMqttRx(char *topic, byte *message, unsigned int length) {
         int16_t jsonBri      = (doc["bri"] | -1)       >= 0 ? doc["bri"].as<int16_t>()      : -1;
         int8_t jsonColorMode = (doc["colorMode"] | -1) >= 0 ? doc["colorMode"].as<int8_t>() : -1;
         int16_t jsonSpeed    = (doc["speed"] | -1)     >= 0 ? doc["speed"].as<int16_t>()    : -1;
+        long jsonFade        = (doc["fade"] | -1)      >= 0 ? doc["fade"].as<long>()        : -1;
+        int8_t jsonPalette   = (doc["palette"] | -1)   >= 0 ? doc["palette"].as<int8_t>()   : -1;
+        long jsonPower       = (doc["power"] | -1)     >= 0 ? doc["power"].as<long>()       : -1;
+        int8_t jsonSegments  = (doc["segments"] | -1)  >= 0 ? doc["segments"].as<int8_t>()  : -1;
+        int16_t jsonFps      = (doc["fps"] | -1)       >= 0 ? doc["fps"].as<int16_t>()      : -1;
+        JsonArray jsonSegment = doc["segment"]; // [index, start, count, colorMode, hue, sat, speed, bri]
+        JsonArray jsonMatrix  = doc["matrix"];  // [width, height, layout]
+        JsonArray jsonBalance = doc["balance"]; // [red, green, blue]
         if (DEBUG_LEVEL & DEBUG_WEBSERVER_EVENTS) {
             Serial.printf("[%s::%s] ", CLASS_NAME, __FUNCTION__);
             if (jsonSwitch    >= 0) Serial.printf("switch:%d\n                   ",    jsonSwitch);
@@ -111,8 +120,55 @@ void vMqttRx(char *topic, byte *message, unsigned int length) {
             if (jsonBri       >= 0) Serial.printf("bri:%d\n                   ",       jsonBri);
             if (jsonColorMode >= 0) Serial.printf("colorMode:%d\n                   ", jsonColorMode);
             if (jsonSpeed     >= 0) Serial.printf("Speed:%d\n                   ",     jsonSpeed);
+            if (jsonFade      >= 0) Serial.printf("fade:%ld\n                   ",     jsonFade);
+            if (jsonPalette   >= 0) Serial.printf("palette:%d\n                   ",   jsonPalette);
+            if (jsonPower     >= 0) Serial.printf("power:%ld\n                   ",    jsonPower);
+            if (jsonSegments  >= 0) Serial.printf("segments:%d\n                   ",  jsonSegments);
+            if (jsonFps       >= 0) Serial.printf("fps:%d\n                   ",       jsonFps);
+            if (jsonSegment.size() == 8) Serial.printf("segment:%d\n                   ", jsonSegment[0].as<int>());
+            if (jsonMatrix.size() == 3) Serial.printf("matrix:%dx%d\n                   ", jsonMatrix[0].as<int>(), jsonMatrix[1].as<int>());
+            if (jsonBalance.size() == 3) Serial.printf("balance:%d,%d,%d\n                   ", jsonBalance[0].as<int>(), jsonBalance[1].as<int>(), jsonBalance[2].as<int>());
             Serial.printf("\n");
         }
+        if (jsonFade >= 0) oLedStripe.vSetFadeTime(jsonFade > 0xffff ? 0xffff : (uint16_t)jsonFade); // crossfade time [ms]
+        if (jsonFps >= 0) oLedStripe.vSetFrameRate(jsonFps > 0xff ? 0xff : (uint8_t)jsonFps); // target frame rate [1/s]
+        if (jsonBalance.size() == 3) {
+            // color balance of the stripe, 255: no correction
+            oLedStripe.vSetColorBalance(jsonBalance[0].as<uint8_t>(), jsonBalance[1].as<uint8_t>(), jsonBalance[2].as<uint8_t>());
+        }
+        if (jsonSegment.size() == 8) {
+            // define one segment of the stripe
+            tSegment stSegment = {
+                jsonSegment[1].as<uint16_t>(), // start
+                jsonSegment[2].as<uint16_t>(), // count
+                jsonSegment[4].as<uint16_t>(), // hue
+                jsonSegment[3].as<uint8_t>(),  // colorMode
+                jsonSegment[5].as<uint8_t>(),  // sat
+                jsonSegment[6].as<uint8_t>(),  // speed
+                jsonSegment[7].as<uint8_t>()   // bri
+            };
+            if (!oLedStripe.boSetSegment(jsonSegment[0].as<uint8_t>(), stSegment)) {
+                Serial.printf("[%s::%s] invalid segment:%d\n", CLASS_NAME, __FUNCTION__, jsonSegment[0].as<int>());
+            }
+        }
+        if (jsonPower >= 0) {
+            oLedStripe.vSetPowerBudget(jsonPower >= 0xffff ? 0 : (uint16_t)jsonPower); // max. current [mA], 0: unlimited
+            pWebServer->vSendPowerStatus(-1, true);
+        }
+        if (jsonPalette >= 0) {
+            oLedStripe.vSetPalette((uint8_t)jsonPalette, -1);
+            pWebServer->vSendColorMode(-1, true);
+        }
+        if (jsonMatrix.size() == 3) {
+            // 2D layout of the stripe, width or height 0: linear stripe
+            if (!oLedStripe.boSetMatrix(jsonMatrix[0].as<uint8_t>(), jsonMatrix[1].as<uint8_t>(), jsonMatrix[2].as<uint8_t>())) {
+                Serial.printf("[%s::%s] invalid matrix\n", CLASS_NAME, __FUNCTION__);
+            }
+        }
+        if (jsonSegments >= 0 || jsonSegment.size() == 8 || jsonMatrix.size() == 3) {
+            if (jsonSegments >= 0) oLedStripe.vSetSegmentCount((uint8_t)jsonSegments);
+            oLedStripe.vSetColor(-1); // show the new segments
+        }
         if (jsonHue >= 0 || jsonSat >= 0 || jsonBri >= 0 || jsonColorMode >= 0 || jsonSpeed >=0 ) {
             oEep.vSetSpeed(jsonSpeed >= 0 ? (int8_t)jsonSpeed : oEep.u8Speed, true );
             oLedStripe.vSetValues(
@@ -129,16 +185,23 @@ void vMqttRx(char *topic, byte *message, unsigned int length) {
 
 //=======================================================================
 void vMqttTx() {
-    char payload[100];
-    sprintf(
+    char payload[250];
+    snprintf(
         payload,
-        "{\"switch\":%d,\"hue\":%d,\"sat\":%d,\"bri\":%d,\"colorMode\":%d,\"speed\":%d}", //,\"sunHasRisen\":1,\"time\":2}",
+        sizeof(payload),
+        "{\"switch\":%d,\"hue\":%d,\"sat\":%d,\"bri\":%d,\"colorMode\":%d,\"speed\":%d,\"palette\":%d,\"powerScale\":%d,\"framesSent\":%lu,\"framesSkipped\":%lu,\"fps\":%d,\"jitter\":%lu}", //,\"sunHasRisen\":1,\"time\":2}",
         oLedStripe.boGetSwitchStatus(),
         oEep.u16Hue,
         oEep.u8Saturation,
         oLedStripe.u8GetBrightness(),
         oEep.u8ColorMode,
-        oEep.u8Speed);
+        oEep.u8Speed,
+        oEep.u8Palette,
+        (oLedStripe.u8GetPowerScale() * 100 + 127) / 255, // power limiter [%]
+        (unsigned long)oLedStripe.u32GetFramesSent(),
+        (unsigned long)oLedStripe.u32GetFramesSkipped(),
+        oLedStripe.u16GetFps(),         // measured frame rate [1/s]
+        oLedStripe.ulGetFrameJitter()); // frame jitter [us]
     mqttClient.publish(acMqttTxTopic, payload);
     if (DEBUG_LEVEL & DEBUG_WEBSERVER_EVENTS) {
         Serial.printf("[%s::%s] %s = %s\n", CLASS_NAME, __FUNCTION__, acMqttTxTopic, payload);
@@ -187,6 +250,7 @@ void setup() {
     vPrintChipInfo();
     Serial.setDebugOutput(DEBUG_LEVEL & DEBUG_GLOBAL_OUTPUT ? true : false);
 
+    vRandomInit();                      // seed the effect PRNG
     oEep.vInit(&oNtpTime);              // download all EEP values
     oLedStripe.vInit(&oEep, &oNtpTime); // init LED strip
     oButtons.vInit(&oLedStripe, &oEep, &oNtpTime); // init Buttons
@@ -222,6 +286,7 @@ void loop() {
     oLedStripe.vLoop(); // damp stripe changes
     oWlan.vLoop();      // check Wlan status, reconnect
     oNtpTime.vLoop();   // calculate sunrise and sun set dependent on the current time
+    oEep.vLoop();       // commit the changed EEP values, when they are quiet
 
     if (oWlan.boSSIDconnected) {
 
@@ -0,0 +1,70 @@
+#ifndef Arduino_h
+#define Arduino_h
+// host replacement of the Arduino/ESP8266 core for the native environment,
+// only what the LED rendering code needs
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#define PROGMEM
+#define memcpy_P memcpy
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+
+// binary constants of the core (binary.h), used by DebugLevel.h
+#define B00000001 0x01
+#define B00000010 0x02
+#define B00000100 0x04
+#define B00001000 0x08
+#define B00010000 0x10
+#define B00100000 0x20
+#define B01000000 0x40
+#define B10000000 0x80
+#define B10100000 0xa0
+
+extern long long llMockMicros; // virtual clock of millis()/micros() [us]
+unsigned long millis();
+unsigned long micros();
+long random(long, long);
+
+class String : public std::string {
+    public:
+        String() {}
+        String(const char *pc) : std::string(pc ? pc : "") {}
+        int indexOf(const char *pc) const { size_t pos = find(pc); return pos == npos ? -1 : (int)pos; }
+        String substring(int iStart, int iEnd) const { return String(std::string::substr(iStart, iEnd - iStart).c_str()); }
+        long toInt() const { return atol(c_str()); }
+};
+
+class IPAddress {
+    public:
+        uint8_t operator[](int) const { return 0; }
+};
+
+class HardwareSerial {
+    public:
+        int printf(const char *, ...) __attribute__((format(printf, 2, 3)));
+        void println(const char *pc = "") { puts(pc); }
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+    public:
+        uint32_t getChipId() { return 0x00123456; }
+        uint32_t getFreeHeap();                                 // see MockStubs.h
+        uint32_t getMaxFreeBlockSize();
+        uint8_t getHeapFragmentation();
+        uint32_t random() { return 0x12345678; }
+        uint32_t getSketchSize() { return 0; }
+        void restart() {}
+        bool flashEraseSector(uint32_t);                        // see MockStubs.h
+        bool flashWrite(uint32_t, const uint32_t *, size_t);
+        bool flashRead(uint32_t, uint32_t *, size_t);
+};
+extern EspClass ESP;
+
+#endif
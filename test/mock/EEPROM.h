@@ -0,0 +1,19 @@
+#ifndef EEPROM_h
+#define EEPROM_h
+#include <Arduino.h>
+
+class EEPROMClass {
+    public:
+        void begin(size_t) {}
+        template <class T> T &get(int iAdr, T &t) { memcpy(&t, au8Data + iAdr, sizeof(T)); return t; }
+        template <class T> const T &put(int iAdr, const T &t) { memcpy(au8Data + iAdr, &t, sizeof(T)); return t; }
+        uint8_t read(int iAdr) { return au8Data[iAdr]; }
+        void write(int iAdr, uint8_t u8Val) { au8Data[iAdr] = u8Val; }
+        bool commit() { u32Commits++; return true; }
+        uint8_t *getDataPtr() { return au8Data; }
+        uint8_t  au8Data[4096];
+        uint32_t u32Commits = 0;
+};
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1 @@
+// the web server is not part of the native build
@@ -0,0 +1,6 @@
+#ifndef ESPAsyncWebServer_h
+#define ESPAsyncWebServer_h
+// the web server is not part of the native build, only its types
+class AsyncWebServer;
+class AsyncWebServerRequest;
+#endif
@@ -0,0 +1,58 @@
+#ifndef EffectHarness_h
+#define EffectHarness_h
+// one LedStripe with a fixed configuration and a virtual clock, shared by
+// the effect goldens and the benchmark
+#include "LedStripe.h"
+#include "Eep.h"
+#include "NtpTime.h"
+#include "Random.h"
+#include <NeoPixelBus.h>
+
+#define HarnessStartTime   1000000LL // virtual clock at the start, FrameTimer and PT1 read it [us]
+#define HarnessFramePeriod 20        // virtual time per step, 50 fps [ms]
+#define HarnessBrightness  200
+#define HarnessSpeed       192
+
+class EffectHarness {
+    public:
+        // LED count, color mode, matrix width (0: linear stripe), height = u16LedCount / width
+        EffectHarness(uint16_t u16LedCount, tColorMode enMode, uint8_t u8MatrixWidth) : cEep(0), cNtpTime(0), cLedStripe(0) {
+            vRandomInit(); // fixed seed with RANDOM_FIXED_SEED
+            cNtpTime.stLocal.boSunHasRisen = true;
+            cEep.vInit(&cNtpTime);
+            cEep.vSetLedCount(u16LedCount, false);
+            cEep.vSetSegmentCount(0, false);
+            cEep.vSetHue(0, false);
+            cEep.vSetSaturation(255, false);
+            cEep.vSetBrightnessDay(HarnessBrightness, false);
+            cEep.vSetColorMode(enMode, false);
+            cEep.vSetSpeed(HarnessSpeed, false);
+            cEep.vSetPalette(0, false);
+            cEep.vSetPowerBudget(0, false);
+            cEep.vSetPowerOnRestoreSwitch(0, false);
+            cLedStripe.vInit(&cEep, &cNtpTime);
+            cLedStripe.boSetMatrix(u8MatrixWidth, u8MatrixWidth ? u16LedCount / u8MatrixWidth : 0, nRowMajorAlternating);
+            cLedStripe.vSetFadeTime(0);
+            cLedStripe.vTurn(true, true);
+        }
+
+        // advance the virtual clock by one frame and run the stripe loop,
+        // returns the pixel buffer of the last transmitted frame (GRB)
+        const std::vector<uint8_t> &au8Step() {
+            llMockMicros += HarnessFramePeriod * 1000LL;
+            cLedStripe.vLoop();
+            cLedStripe.vLoop(); // the rendered frame is sent, when the DMA is idle
+            return au8MockShownFrame;
+        }
+
+    private:
+        // constructed first, the FrameTimer of LedStripe reads the clock in its constructor
+        struct tMockClock { tMockClock() { llMockMicros = HarnessStartTime; } } stClock;
+
+    public:
+        Eep       cEep;
+        NtpTime   cNtpTime;
+        LedStripe cLedStripe;
+};
+
+#endif
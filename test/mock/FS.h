@@ -0,0 +1,36 @@
+#ifndef FS_h
+#define FS_h
+#include <Arduino.h>
+
+enum SeekMode { SeekSet = SEEK_SET, SeekCur = SEEK_CUR, SeekEnd = SEEK_END };
+
+// SPIFFS files are host files below test/output/fs
+class File {
+    public:
+        operator bool() const { return pFile != NULL; }
+        size_t read(uint8_t *pu8, size_t size) { return pFile ? fread(pu8, 1, size, pFile) : 0; }
+        size_t write(const uint8_t *pu8, size_t size) { return pFile ? fwrite(pu8, 1, size, pFile) : 0; }
+        int available() { return (int)(size() - ftell(pFile)); }
+        bool seek(uint32_t u32Pos, SeekMode enMode) { return pFile && !fseek(pFile, u32Pos, enMode); }
+        size_t size() {
+            long lPos = ftell(pFile); fseek(pFile, 0, SEEK_END);
+            long lEnd = ftell(pFile); fseek(pFile, lPos, SEEK_SET);
+            return (size_t)lEnd;
+        }
+        void close() { if (pFile) fclose(pFile); pFile = NULL; }
+        FILE *pFile = NULL;
+};
+
+class FS {
+    public:
+        bool begin() { return true; }
+        File open(const char *pcPath, const char *pcMode) {
+            File file;
+            std::string sPath = std::string("test/output/fs") + pcPath;
+            file.pFile = fopen(sPath.c_str(), (*pcMode == 'w') ? "wb" : "rb");
+            return file;
+        }
+};
+extern FS SPIFFS;
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef MockStubs_h
+#define MockStubs_h
+// definitions of the host mocks and of the device functions, which LedStripe
+// and Eep call outside the native build (web server, NTP). Include it once
+// per test program.
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <FS.h>
+#include <NeoPixelBus.h>
+#include <stdarg.h>
+#include "LedStripe.h"
+#include "WebServer.h"
+#include "NtpTime.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+EEPROMClass EEPROM;
+FS SPIFFS;
+std::vector<uint8_t> au8MockShownFrame;
+uint32_t u32MockShows = 0;
+long long llMockMicros = 0;
+
+// NOR flash of MockFlashSectors sectors: an erase sets all bits, a write can
+// only clear bits. lMockFlashWriteBudget simulates a power loss, the writes
+// stop after that many bytes (-1: unlimited).
+#define MockFlashSectors 16
+std::vector<uint8_t>  au8MockFlash(MockFlashSectors * 4096, 0xff);
+std::vector<uint32_t> au32MockFlashErases(MockFlashSectors, 0);
+long lMockFlashWriteBudget = -1;
+
+bool EspClass::flashEraseSector(uint32_t u32Sector) {
+    if ((u32Sector >= MockFlashSectors) || !lMockFlashWriteBudget) return false;
+    memset(&au8MockFlash[u32Sector * 4096], 0xff, 4096);
+    au32MockFlashErases[u32Sector]++;
+    return true;
+}
+bool EspClass::flashWrite(uint32_t u32Adr, const uint32_t *pu32Data, size_t size) {
+    if ((u32Adr & 3) || (size & 3) || (u32Adr + size > au8MockFlash.size())) return false;
+    const uint8_t *pu8Data = (const uint8_t *)pu32Data;
+    for (size_t i = 0; i < size; i++) {
+        if (!lMockFlashWriteBudget) return false;
+        if (lMockFlashWriteBudget > 0) lMockFlashWriteBudget--;
+        au8MockFlash[u32Adr + i] &= pu8Data[i];
+    }
+    return true;
+}
+bool EspClass::flashRead(uint32_t u32Adr, uint32_t *pu32Data, size_t size) {
+    if ((u32Adr & 3) || (size & 3) || (u32Adr + size > au8MockFlash.size())) return false;
+    memcpy(pu32Data, &au8MockFlash[u32Adr], size);
+    return true;
+}
+
+// counting allocator: malloc() and free() of the test program (glibc) are
+// counted and, between vMockHeapStart() and vMockHeapStop(), placed into a
+// virtual heap of MockHeapSize like umm_malloc of the ESP8266 core (best fit,
+// 8 byte blocks incl. 4 byte header). ESP reports its free heap and largest
+// free block, an allocation, which doesn't fit, fails. Outside, ESP reports
+// fixed values.
+#define MockHeapSize   40000
+#define MockHeapBlocks 1024
+struct tMockBlock {
+    void    *pv;
+    uint32_t u32Start;
+    uint32_t u32Len;
+};
+tMockBlock astMockBlocks[MockHeapBlocks]; // sorted by u32Start
+uint32_t u32MockBlocks = 0;
+uint32_t u32MockAllocs = 0;               // allocations of the virtual heap
+bool     boMockHeap    = false;
+
+extern "C" void *__libc_malloc(size_t);
+extern "C" void *__libc_calloc(size_t, size_t);
+extern "C" void  __libc_free(void *);
+extern "C" size_t malloc_usable_size(void *);
+
+static bool boMockPlace(void *pv, size_t size) {
+    if (!boMockHeap) return true;
+    uint32_t u32Len = ((uint32_t)size + 4 + 7) & ~7u;
+    uint32_t u32Best = MockHeapBlocks; // index of the block after the best gap
+    uint32_t u32BestGap = 0xffffffff;
+    uint32_t u32End = 0;
+    for (uint32_t u32Idx = 0; u32Idx <= u32MockBlocks; u32Idx++) {
+        uint32_t u32Next = (u32Idx < u32MockBlocks) ? astMockBlocks[u32Idx].u32Start : MockHeapSize;
+        uint32_t u32Gap  = u32Next - u32End;
+        if ((u32Gap >= u32Len) && (u32Gap < u32BestGap)) {
+            u32Best    = u32Idx;
+            u32BestGap = u32Gap;
+        }
+        if (u32Idx < u32MockBlocks) u32End = astMockBlocks[u32Idx].u32Start + astMockBlocks[u32Idx].u32Len;
+    }
+    if ((u32Best == MockHeapBlocks) || (u32MockBlocks == MockHeapBlocks)) return false;
+    uint32_t u32Start = u32Best ? astMockBlocks[u32Best - 1].u32Start + astMockBlocks[u32Best - 1].u32Len : 0;
+    memmove(&astMockBlocks[u32Best + 1], &astMockBlocks[u32Best], (u32MockBlocks - u32Best) * sizeof(tMockBlock));
+    astMockBlocks[u32Best] = {pv, u32Start, u32Len};
+    u32MockBlocks++;
+    u32MockAllocs++;
+    return true;
+}
+
+static void vMockRemove(void *pv) {
+    for (uint32_t u32Idx = 0; u32Idx < u32MockBlocks; u32Idx++) {
+        if (astMockBlocks[u32Idx].pv == pv) {
+            u32MockBlocks--;
+            memmove(&astMockBlocks[u32Idx], &astMockBlocks[u32Idx + 1], (u32MockBlocks - u32Idx) * sizeof(tMockBlock));
+            return;
+        }
+    }
+}
+
+extern "C" void *malloc(size_t size) {
+    void *pv = __libc_malloc(size);
+    if (pv && !boMockPlace(pv, size)) {
+        __libc_free(pv);
+        return NULL;
+    }
+    return pv;
+}
+extern "C" void *calloc(size_t count, size_t size) {
+    void *pv = __libc_calloc(count, size);
+    if (pv && !boMockPlace(pv, count * size)) {
+        __libc_free(pv);
+        return NULL;
+    }
+    return pv;
+}
+extern "C" void free(void *pv) {
+    if (!pv) return;
+    vMockRemove(pv);
+    __libc_free(pv);
+}
+extern "C" void *realloc(void *pv, size_t size) {
+    if (!pv) return malloc(size);
+    if (!size) {
+        free(pv);
+        return NULL;
+    }
+    void *pvNew = malloc(size);
+    if (pvNew) {
+        size_t sizeOld = malloc_usable_size(pv);
+        memcpy(pvNew, pv, (sizeOld < size) ? sizeOld : size);
+        free(pv);
+    }
+    return pvNew;
+}
+
+void vMockHeapStart() {
+    u32MockBlocks = 0;
+    u32MockAllocs = 0;
+    boMockHeap    = true;
+}
+void vMockHeapStop() {
+    boMockHeap    = false;
+    u32MockBlocks = 0; // later frees of the placed blocks are ignored
+}
+uint32_t u32MockHeapUsed() {
+    uint32_t u32Used = 0;
+    for (uint32_t u32Idx = 0; u32Idx < u32MockBlocks; u32Idx++) u32Used += astMockBlocks[u32Idx].u32Len;
+    return u32Used;
+}
+
+uint32_t EspClass::getFreeHeap() { return boMockHeap ? MockHeapSize - u32MockHeapUsed() : 40000; }
+uint32_t EspClass::getMaxFreeBlockSize() {
+    if (!boMockHeap) return 30000;
+    uint32_t u32Max = 0;
+    uint32_t u32End = 0;
+    for (uint32_t u32Idx = 0; u32Idx <= u32MockBlocks; u32Idx++) {
+        uint32_t u32Next = (u32Idx < u32MockBlocks) ? astMockBlocks[u32Idx].u32Start : MockHeapSize;
+        if (u32Next - u32End > u32Max) u32Max = u32Next - u32End;
+        if (u32Idx < u32MockBlocks) u32End = astMockBlocks[u32Idx].u32Start + astMockBlocks[u32Idx].u32Len;
+    }
+    return u32Max;
+}
+uint8_t EspClass::getHeapFragmentation() {
+    uint32_t u32Free = getFreeHeap();
+    return (boMockHeap && u32Free) ? (uint8_t)(100 - (uint64_t)getMaxFreeBlockSize() * 100 / u32Free) : 0;
+}
+
+unsigned long millis() { return (unsigned long)(llMockMicros / 1000); }
+unsigned long micros() { return (unsigned long)llMockMicros; }
+long random(long lMin, long lMax) { return (lMax > lMin) ? lMin + rand() % (lMax - lMin) : lMin; }
+
+int HardwareSerial::printf(const char *pcFormat, ...) {
+    va_list args;
+    va_start(args, pcFormat);
+    int iLen = vprintf(pcFormat, args);
+    va_end(args);
+    return iLen;
+}
+
+NtpTime::NtpTime(uint8_t u8NewDebugLevel) { u8DebugLevel = u8NewDebugLevel; }
+void NtpTime::vInit(char *, char *, char *, char *, double, double) {}
+
+void WebServer::vSendStripeStatus(int, bool) {}
+void WebServer::vSendPowerStatus(int, bool) {}
+void WebServer::vSendFrameStatus(int, bool) {}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef NeoPixelBus_h
+#define NeoPixelBus_h
+// Host replacement of NeoPixelBus (see: https://github.com/Makuna/NeoPixelBus)
+// with the same pixel layout (GRB, 3 byte per LED). Show() copies the pixel
+// buffer into au8MockShownFrame, where the tests read the sent frame.
+#include <Arduino.h>
+#include <vector>
+
+struct HsbColor {
+    HsbColor(float fH, float fS, float fB) : H(fH), S(fS), B(fB) {}
+    float H;
+    float S;
+    float B;
+};
+
+struct RgbColor {
+    RgbColor(uint8_t u8Bri = 0) : R(u8Bri), G(u8Bri), B(u8Bri) {}
+    RgbColor(uint8_t u8R, uint8_t u8G, uint8_t u8B) : R(u8R), G(u8G), B(u8B) {}
+    // float conversion of RgbColorBase::_HsbToRgb(), the reference of rgbHsbToRgb()
+    RgbColor(const HsbColor &hsb) {
+        float fR, fG, fB;
+        float fH = hsb.H;
+        float fV = hsb.B;
+        if (hsb.S == 0.0f) {
+            fR = fG = fB = fV;
+        } else {
+            if (fH < 0.0f) fH += 1.0f;
+            else if (fH >= 1.0f) fH -= 1.0f;
+            fH *= 6.0f;
+            int iSector = (int)fH;
+            float fF = fH - iSector;
+            float fQ = fV * (1.0f - hsb.S * fF);
+            float fP = fV * (1.0f - hsb.S);
+            float fT = fV * (1.0f - hsb.S * (1.0f - fF));
+            switch (iSector) {
+                case 0:  fR = fV; fG = fT; fB = fP; break;
+                case 1:  fR = fQ; fG = fV; fB = fP; break;
+                case 2:  fR = fP; fG = fV; fB = fT; break;
+                case 3:  fR = fP; fG = fQ; fB = fV; break;
+                case 4:  fR = fT; fG = fP; fB = fV; break;
+                default: fR = fV; fG = fP; fB = fQ; break;
+            }
+        }
+        R = (uint8_t)(fR * 255);
+        G = (uint8_t)(fG * 255);
+        B = (uint8_t)(fB * 255);
+    }
+    uint8_t R;
+    uint8_t G;
+    uint8_t B;
+};
+
+struct Rgb48Color {
+    Rgb48Color(uint16_t u16R, uint16_t u16G, uint16_t u16B) : R(u16R), G(u16G), B(u16B) {}
+    uint16_t R;
+    uint16_t G;
+    uint16_t B;
+};
+
+struct NeoEase {
+    static float Gamma(float fUnit) { return powf(fUnit, 1.0f / 0.45f); }
+};
+
+struct NeoGrbFeature {
+    typedef RgbColor ColorObject;
+    static const size_t PixelSize = 3;
+    static void applyPixelColor(uint8_t *pu8Pixels, uint16_t u16Idx, const RgbColor &rgb) {
+        uint8_t *pu8 = pu8Pixels + (size_t)u16Idx * PixelSize;
+        pu8[0] = rgb.G; pu8[1] = rgb.R; pu8[2] = rgb.B;
+    }
+};
+
+struct Neo800KbpsMethod {};
+
+#define MockDmaBytesPerPixel 12 // I2S buffer of the ESP8266 DMA method (4 bit per data bit)
+
+extern std::vector<uint8_t> au8MockShownFrame; // pixel buffer of the last Show()
+extern uint32_t u32MockShows;
+
+template <typename T_COLOR_FEATURE, typename T_METHOD> class NeoPixelBus {
+    public:
+        NeoPixelBus(uint16_t u16Count) : u16PixelCount(u16Count) {
+            pu8Pixels = (uint8_t *)calloc(u16Count, T_COLOR_FEATURE::PixelSize);
+            pu8Dma    = (uint8_t *)malloc((size_t)u16Count * MockDmaBytesPerPixel);
+        }
+        ~NeoPixelBus() { free(pu8Pixels); free(pu8Dma); }
+        void Begin() { memset(pu8Pixels, 0, PixelsSize()); }
+        void Show(bool = true) { au8MockShownFrame.assign(pu8Pixels, pu8Pixels + PixelsSize()); u32MockShows++; }
+        bool CanShow() const { return true; }
+        uint8_t *Pixels() { return pu8Pixels; }
+        size_t PixelsSize() const { return (size_t)u16PixelCount * T_COLOR_FEATURE::PixelSize; }
+        uint16_t PixelCount() const { return u16PixelCount; }
+        void SetPixelColor(uint16_t u16Idx, typename T_COLOR_FEATURE::ColorObject color) {
+            if (u16Idx < u16PixelCount) T_COLOR_FEATURE::applyPixelColor(pu8Pixels, u16Idx, color);
+        }
+        void ClearTo(typename T_COLOR_FEATURE::ColorObject color) { ClearTo(color, 0, u16PixelCount - 1); }
+        void ClearTo(typename T_COLOR_FEATURE::ColorObject color, uint16_t u16First, uint16_t u16Last) {
+            for (uint32_t u32Idx = u16First; u32Idx <= u16Last; u32Idx++) SetPixelColor(u32Idx, color);
+        }
+
+    private:
+        uint16_t u16PixelCount;
+        uint8_t *pu8Pixels;
+        uint8_t *pu8Dma; // unused, only weighs on the heap like the I2S buffer
+};
+
+// layouts of NeoPixelBus, see: https://github.com/Makuna/NeoPixelBus/wiki/Layout-objects
+struct RowMajorLayout {
+    static uint16_t Map(uint16_t u16W, uint16_t, uint16_t u16X, uint16_t u16Y) { return u16Y * u16W + u16X; }
+};
+struct RowMajorAlternatingLayout {
+    static uint16_t Map(uint16_t u16W, uint16_t, uint16_t u16X, uint16_t u16Y) { return u16Y * u16W + ((u16Y & 1) ? (u16W - 1 - u16X) : u16X); }
+};
+struct ColumnMajorLayout {
+    static uint16_t Map(uint16_t, uint16_t u16H, uint16_t u16X, uint16_t u16Y) { return u16X * u16H + u16Y; }
+};
+struct ColumnMajorAlternatingLayout {
+    static uint16_t Map(uint16_t, uint16_t u16H, uint16_t u16X, uint16_t u16Y) { return u16X * u16H + ((u16X & 1) ? (u16H - 1 - u16Y) : u16Y); }
+};
+
+template <typename T_LAYOUT> class NeoTopology {
+    public:
+        NeoTopology(uint16_t u16W, uint16_t u16H) : u16Width(u16W), u16Height(u16H) {}
+        uint16_t Map(int16_t i16X, int16_t i16Y) const {
+            if (i16X >= (int16_t)u16Width) i16X = u16Width - 1; else if (i16X < 0) i16X = 0;
+            if (i16Y >= (int16_t)u16Height) i16Y = u16Height - 1; else if (i16Y < 0) i16Y = 0;
+            return T_LAYOUT::Map(u16Width, u16Height, i16X, i16Y);
+        }
+
+    private:
+        uint16_t u16Width;
+        uint16_t u16Height;
+};
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef WebSocketsServer_h
+#define WebSocketsServer_h
+// the web server is not part of the native build, only its types
+class WebSocketsServer;
+enum WStype_t { WStype_ERROR, WStype_DISCONNECTED, WStype_CONNECTED, WStype_TEXT };
+#endif
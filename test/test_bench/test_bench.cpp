@@ -0,0 +1,122 @@
+// render benchmark of the effects on the host: time of LedStripe::vLoop per
+// frame (effect, gamma, power estimation, frame buffer) at several LED counts.
+// The host is much faster than the ESP8266, compare the numbers relative to
+// each other and between commits, not with the device.
+#include <unity.h>
+#include <chrono>
+#include "MockStubs.h"
+#include "EffectHarness.h"
+#include "ColorUtils.h"
+
+#define BenchFrames       500
+#define BenchDitherLeds   300
+#define BenchEspSlowdown  50  // estimated time ratio ESP8266 (160MHz) / host, conservative
+
+static const uint16_t au16BenchLedCounts[] = {60, 300, 1000};
+
+//=============================================================================
+// time of one frame of the effect [ns]
+static double dBenchFrameNs(tColorMode enMode, uint16_t u16LedCount) {
+    bool boMatrix = (enMode == nRainbow2D) || (enMode == nMovingPoint2D);
+    EffectHarness cHarness(u16LedCount, enMode, boMatrix ? 20 : 0); // 20x3, 20x15, 20x50
+    cHarness.au8Step(); // first frame initializes the effect state
+    std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+    for (uint16_t u16Frame = 0; u16Frame < BenchFrames; u16Frame++) cHarness.au8Step();
+    double dNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tStart).count();
+    TEST_ASSERT_EQUAL(u16LedCount * NeoGrbFeature::PixelSize, au8MockShownFrame.size());
+    return dNs / BenchFrames;
+}
+
+//=============================================================================
+static void vBenchEffect(tColorMode enMode) {
+    for (uint16_t u16LedCount : au16BenchLedCounts) {
+        double dNs = dBenchFrameNs(enMode, u16LedCount);
+        char buffer[100];
+        snprintf(buffer, sizeof(buffer), "%-14s LEDs:%4d %7.2f ns/pixel %9.0f frames/s",
+            astEffects[enMode].pcName, u16LedCount, dNs / u16LedCount, 1e9 / dNs);
+        TEST_MESSAGE(buffer);
+    }
+}
+
+//=============================================================================
+// each effect with the float HSB conversion of NeoPixelBus (RgbColor(HsbColor(...)),
+// the path before the fixed-point kernel) and with rgbHsbToRgb(), the
+// accuracy of the kernel is checked by test_color
+void test_hsb_float_fixed() {
+    for (uint8_t u8Mode = 0; u8Mode < nAnimation; u8Mode++) {
+        for (uint16_t u16LedCount : au16BenchLedCounts) {
+            boHsbFloat = true;
+            double dFloatNs = dBenchFrameNs((tColorMode)u8Mode, u16LedCount);
+            boHsbFloat = false;
+            double dFixedNs = dBenchFrameNs((tColorMode)u8Mode, u16LedCount);
+            char buffer[100];
+            snprintf(buffer, sizeof(buffer), "%-14s LEDs:%4d float %8.2f us/frame, fixed %8.2f us/frame",
+                astEffects[u8Mode].pcName, u16LedCount, dFloatNs / 1000, dFixedNs / 1000);
+            TEST_MESSAGE(buffer);
+        }
+    }
+}
+
+//=============================================================================
+// cost of the dither: the 16 bit color of 300 LEDs converted with remainders
+// and with rounding only, and a whole dim rainbow frame against the render
+// budget of the FrameTimer (scaled by BenchEspSlowdown)
+void test_dither_budget() {
+    static uint8_t au8Rest[BenchDitherLeds * GammaLutDitherBytes];
+    GammaLut cGammaLut;
+    cGammaLut.vSetBrightness(20);
+    uint32_t u32Sum = 0;
+    double adNs[2];
+    for (uint8_t u8Dither = 0; u8Dither < 2; u8Dither++) {
+        cGammaLut.vSetDitherBuffer(u8Dither ? au8Rest : NULL, BenchDitherLeds);
+        std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+        for (uint16_t u16Frame = 0; u16Frame < BenchFrames; u16Frame++) {
+            for (uint16_t u16Led = 0; u16Led < BenchDitherLeds; u16Led++) {
+                RgbColor rgbColor = cGammaLut.rgbCorrect(RgbColor((uint8_t)u16Led, (uint8_t)u16Frame, 0xff), u16Led);
+                u32Sum += rgbColor.R + rgbColor.G + rgbColor.B;
+            }
+        }
+        adNs[u8Dither] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tStart).count() / BenchFrames / BenchDitherLeds;
+    }
+    char buffer[100];
+    snprintf(buffer, sizeof(buffer), "GammaLut LEDs:%d %.2f ns/pixel dithered, %.2f ns/pixel rounded (sum %lu)",
+        BenchDitherLeds, adNs[1], adNs[0], (unsigned long)u32Sum);
+    TEST_MESSAGE(buffer);
+
+    EffectHarness cHarness(BenchDitherLeds, nRainbow, 0);
+    cHarness.cEep.vSetBrightnessDay(20, false);
+    cHarness.au8Step();
+    std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+    for (uint16_t u16Frame = 0; u16Frame < BenchFrames; u16Frame++) cHarness.au8Step();
+    double dFrameUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - tStart).count() / BenchFrames;
+    FrameTimer cFrameTimer(FrameTimerFpsDefault);
+    snprintf(buffer, sizeof(buffer), "dim Rainbow LEDs:%d %.1f us/frame, x%d: %.0f us of %lu us budget",
+        BenchDitherLeds, dFrameUs, BenchEspSlowdown, dFrameUs * BenchEspSlowdown, cFrameTimer.ulGetFrameBudget());
+    TEST_MESSAGE(buffer);
+    TEST_ASSERT_TRUE(dFrameUs * BenchEspSlowdown < cFrameTimer.ulGetFrameBudget());
+}
+
+void test_monochrome()      { vBenchEffect(nMonochrome); }
+void test_rainbow()         { vBenchEffect(nRainbow); }
+void test_random()          { vBenchEffect(nRandom); }
+void test_moving_point()    { vBenchEffect(nMovingPoint); }
+void test_rainbow_2d()      { vBenchEffect(nRainbow2D); }
+void test_moving_point_2d() { vBenchEffect(nMovingPoint2D); }
+void test_palette()         { vBenchEffect(nPalette); }
+
+void setUp() {}
+void tearDown() { boHsbFloat = false; }
+
+int main(int, char **) {
+    UNITY_BEGIN();
+    RUN_TEST(test_monochrome);
+    RUN_TEST(test_rainbow);
+    RUN_TEST(test_random);
+    RUN_TEST(test_moving_point);
+    RUN_TEST(test_rainbow_2d);
+    RUN_TEST(test_moving_point_2d);
+    RUN_TEST(test_palette);
+    RUN_TEST(test_dither_budget);
+    RUN_TEST(test_hsb_float_fixed);
+    return UNITY_END();
+}
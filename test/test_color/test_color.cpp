@@ -0,0 +1,62 @@
+// the fixed-point HSB kernel against the float conversion of NeoPixelBus
+// (RgbColor(HsbColor(...)), the path of the effects before the kernel)
+#include <unity.h>
+#include "MockStubs.h"
+#include "ColorUtils.h"
+
+#define ColorHueStep 15 // 65535 = 15 * 4369, the grid ends with 0xffff
+#define ColorStep    5  // 255 = 5 * 51, the grid ends with 0xff
+
+//=============================================================================
+static void vCheckColor(uint16_t u16Hue, uint8_t u8Saturation, uint8_t u8Brightness) {
+    boHsbFloat = true;
+    RgbColor rgbFloat = rgbHsbToRgb(u16Hue, u8Saturation, u8Brightness);
+    boHsbFloat = false;
+    RgbColor rgbFixed = rgbHsbToRgb(u16Hue, u8Saturation, u8Brightness);
+    if (   (abs(rgbFloat.R - rgbFixed.R) > 1)
+        || (abs(rgbFloat.G - rgbFixed.G) > 1)
+        || (abs(rgbFloat.B - rgbFixed.B) > 1)) {
+        char buffer[100];
+        snprintf(buffer, sizeof(buffer), "hue:0x%04x sat:%d bri:%d float:%d,%d,%d fixed:%d,%d,%d",
+            u16Hue, u8Saturation, u8Brightness, rgbFloat.R, rgbFloat.G, rgbFloat.B, rgbFixed.R, rgbFixed.G, rgbFixed.B);
+        TEST_MESSAGE(buffer);
+    }
+    TEST_ASSERT_INT_WITHIN(1, rgbFloat.R, rgbFixed.R);
+    TEST_ASSERT_INT_WITHIN(1, rgbFloat.G, rgbFixed.G);
+    TEST_ASSERT_INT_WITHIN(1, rgbFloat.B, rgbFixed.B);
+}
+
+//=============================================================================
+// hue/sat/bri grid, each channel within +/-1 LSB of the float path
+void test_hsb_grid() {
+    for (uint32_t u32Hue = 0; u32Hue <= 0xffff; u32Hue += ColorHueStep) {
+        for (uint16_t u16Sat = 0; u16Sat <= 0xff; u16Sat += ColorStep) {
+            for (uint16_t u16Bri = 0; u16Bri <= 0xff; u16Bri += ColorStep) {
+                vCheckColor((uint16_t)u32Hue, (uint8_t)u16Sat, (uint8_t)u16Bri);
+            }
+        }
+    }
+}
+
+//=============================================================================
+// full saturation and brightness around the sector borders (1/6 of the circle)
+void test_hsb_sector_borders() {
+    for (uint8_t u8Sector = 0; u8Sector <= 6; u8Sector++) {
+        int32_t i32Border = (int32_t)u8Sector * 0xffff / 6;
+        for (int32_t i32Hue = i32Border - 8; i32Hue <= i32Border + 8; i32Hue++) {
+            if ((i32Hue < 0) || (i32Hue > 0xffff)) continue;
+            vCheckColor((uint16_t)i32Hue, 0xff, 0xff);
+            vCheckColor((uint16_t)i32Hue, 0x80, 0xff);
+        }
+    }
+}
+
+void setUp() {}
+void tearDown() { boHsbFloat = false; }
+
+int main(int, char **) {
+    UNITY_BEGIN();
+    RUN_TEST(test_hsb_grid);
+    RUN_TEST(test_hsb_sector_borders);
+    return UNITY_END();
+}
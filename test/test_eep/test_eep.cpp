@@ -0,0 +1,185 @@
+// write-behind of the EEP values: the setters change the image, Eep::vLoop commits it once;
+// layout, validation and export of the field table (EepFields)
+#include <unity.h>
+#include "MockStubs.h"
+#include "Eep.h"
+
+static NtpTime cNtpTime(0);
+
+//=============================================================================
+// Eep with an initialized EEP image, returns the commits of the start
+static uint32_t u32InitEep(Eep &cEep) {
+    llMockMicros = 1000000;
+    cEep.vInit(&cNtpTime);
+    return cEep.u32GetCommits();
+}
+
+//=============================================================================
+static void vAdvanceMs(Eep &cEep, unsigned long ulMs) {
+    llMockMicros += ulMs * 1000LL;
+    cEep.vLoop();
+}
+
+//=============================================================================
+// the defaults of the first start are committed once before the restart
+void test_factory_reset_single_commit() {
+    Eep cEep(0);
+    TEST_ASSERT_EQUAL_UINT32(1, u32InitEep(cEep));
+    TEST_ASSERT_EQUAL_UINT32(0, cEep.u32GetCommitsAvoided()); // all defaults are one change
+    vAdvanceMs(cEep, EepCommitDelay);
+    TEST_ASSERT_EQUAL_UINT32(1, cEep.u32GetCommits());
+}
+
+// turn off: hue, saturation, both brightnesses and the switch status in one commit
+void test_burst_single_commit() {
+    Eep cEep(0);
+    uint32_t u32Commits = u32InitEep(cEep);
+    cEep.vSetHue(cEep.u16Hue + 1, false);
+    cEep.vSetSaturation(cEep.u8Saturation + 1, false);
+    cEep.vSetBrightnessDay(cEep.u8BrightnessDay + 1, false);
+    cEep.vSetBrightnessNight(cEep.u8BrightnessNight + 1, false);
+    cEep.vSetSwitchStatus(!cEep.u8SwitchStatus, false);
+    vAdvanceMs(cEep, EepCommitDelay - 1);
+    TEST_ASSERT_EQUAL_UINT32(u32Commits, cEep.u32GetCommits());
+    vAdvanceMs(cEep, 1);
+    TEST_ASSERT_EQUAL_UINT32(u32Commits + 1, cEep.u32GetCommits());
+    TEST_ASSERT_EQUAL_UINT32(4, cEep.u32GetCommitsAvoided());
+    vAdvanceMs(cEep, EepCommitDelay);
+    TEST_ASSERT_EQUAL_UINT32(u32Commits + 1, cEep.u32GetCommits());
+}
+
+// a value changed every 500ms (MQTT speed) is committed after it got quiet
+void test_changes_postpone_commit() {
+    Eep cEep(0);
+    uint32_t u32Commits = u32InitEep(cEep);
+    for (uint8_t u8Msg = 0; u8Msg < 20; u8Msg++) {
+        cEep.vSetSpeed(cEep.u8Speed + 1, false);
+        vAdvanceMs(cEep, 500);
+    }
+    TEST_ASSERT_EQUAL_UINT32(u32Commits, cEep.u32GetCommits());
+    vAdvanceMs(cEep, EepCommitDelay);
+    TEST_ASSERT_EQUAL_UINT32(u32Commits + 1, cEep.u32GetCommits());
+    TEST_ASSERT_EQUAL_UINT32(19, cEep.u32GetCommitsAvoided());
+}
+
+// unchanged values don't commit, vFlush commits the pending changes at once
+void test_flush() {
+    Eep cEep(0);
+    uint32_t u32Commits = u32InitEep(cEep);
+    cEep.vSetLedCount(cEep.u16LedCount, false);
+    cEep.vFlush();
+    TEST_ASSERT_EQUAL_UINT32(u32Commits, cEep.u32GetCommits());
+    cEep.vSetWiFiMode(!cEep.u8WiFiApMode, false);
+    cEep.vFlush();
+    TEST_ASSERT_EQUAL_UINT32(u32Commits + 1, cEep.u32GetCommits());
+    vAdvanceMs(cEep, EepCommitDelay);
+    TEST_ASSERT_EQUAL_UINT32(u32Commits + 1, cEep.u32GetCommits());
+}
+
+// the generated layout keeps the addresses of the stored data
+void test_layout_unchanged() {
+    TEST_ASSERT_EQUAL(4,   offsetof(tEepData, u16LedCount));
+    TEST_ASSERT_EQUAL(13,  offsetof(tEepData, acWifiSsid));
+    TEST_ASSERT_EQUAL(121, offsetof(tEepData, u8BrightnessNight));
+    TEST_ASSERT_EQUAL(122, offsetof(tEepData, dLongitude));
+    TEST_ASSERT_EQUAL(288, offsetof(tEepData, acTimeZoneName));
+    TEST_ASSERT_EQUAL(341, offsetof(tEepData, astSegments));
+    TEST_ASSERT_EQUAL(425, offsetof(tEepData, u16PowerBudget));
+    TEST_ASSERT_EQUAL(427, offsetof(tEepData, u8FrameRate));
+    TEST_ASSERT_EQUAL(431, sizeof(tEepData));
+}
+
+// stored values out of their range are replaced by the defaults at the start
+void test_invalid_values_default() {
+    Eep cEep(0);
+    u32InitEep(cEep);
+    EEPROM.au8Data[offsetof(tEepData, u8ColorMode)]    = 0xee;
+    EEPROM.au8Data[offsetof(tEepData, u8SegmentCount)] = SegmentsMax + 1;
+    memset(&EEPROM.au8Data[offsetof(tEepData, dLatitude)], 0xff, sizeof(double)); // NaN
+    memset(&EEPROM.au8Data[offsetof(tEepData, acNtpServer1)], 'x', EepStringSize);
+    cEep.vSetHue(cEep.u16Hue + 1, false);
+    cEep.vFlush(); // the log stores the changed image
+    Eep cRestart(0);
+    u32InitEep(cRestart);
+    TEST_ASSERT_EQUAL_UINT8(nMonochrome, cRestart.u8ColorMode);
+    TEST_ASSERT_EQUAL_UINT8(0, cRestart.u8SegmentCount);
+    TEST_ASSERT_TRUE(cRestart.dLatitude == 0);
+    TEST_ASSERT_EQUAL(EepStringSize - 1, strlen(cRestart.acNtpServer1));
+    TEST_ASSERT_EQUAL_STRING(cEep.acTimeZoneName, cRestart.acTimeZoneName);
+}
+
+// one stored segment out of range resets all segments, valid ones are kept
+void test_invalid_segments_default() {
+    Eep cEep(0);
+    u32InitEep(cEep);
+    tSegment stSegment = {10, 20, 0x1000, nRainbow, 0xff, 128, 0xff};
+    cEep.vSetLedCount(100, false);
+    cEep.vSetSegment(0, stSegment, false);
+    cEep.vSetSegmentCount(1, false);
+    cEep.vFlush();
+    Eep cValid(0);
+    u32InitEep(cValid);
+    TEST_ASSERT_EQUAL_UINT8(1, cValid.u8SegmentCount);
+    TEST_ASSERT_EQUAL_UINT16(20, cValid.astSegments[0].u16Count);
+
+    stSegment.u16Start = 90; // behind the stripe
+    cEep.vSetSegment(1, stSegment, false);
+    cEep.vSetSegmentCount(2, false);
+    cEep.vFlush();
+    Eep cRestart(0);
+    u32InitEep(cRestart);
+    TEST_ASSERT_EQUAL_UINT8(0, cRestart.u8SegmentCount);
+    TEST_ASSERT_EQUAL_UINT16(0, cRestart.astSegments[0].u16Count);
+    TEST_ASSERT_EQUAL_UINT16(0, cRestart.astSegments[1].u16Count);
+}
+
+// the setters clamp to the range of the field
+void test_set_clamps() {
+    Eep cEep(0);
+    u32InitEep(cEep);
+    cEep.vSetNumber(nEep_u8SegmentCount, 100, false);
+    TEST_ASSERT_EQUAL_UINT8(SegmentsMax, cEep.u8SegmentCount);
+    cEep.vSetDimMode(7, false);
+    TEST_ASSERT_EQUAL_UINT8(1, cEep.u8DimMode);
+    cEep.vSetLongitude(200.5, false);
+    TEST_ASSERT_TRUE(cEep.dLongitude == 180);
+    cEep.vSetPowerBudget(0xffff, false);
+    TEST_ASSERT_EQUAL_UINT16(0, cEep.u16PowerBudget);
+    cEep.vSetNtp(cEep.acTimeZoneName, (char *)"UTC0", cEep.acNtpServer1, cEep.acNtpServer2, false);
+    TEST_ASSERT_EQUAL_STRING("UTC0", cEep.acTimeZone);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(cEep.acTimeZone, &EEPROM.au8Data[offsetof(tEepData, acTimeZone)], EepStringSize);
+}
+
+// the export contains the values except the secret ones
+void test_export() {
+    Eep cEep(0);
+    u32InitEep(cEep);
+    tSegment stSegment = {10, 20, 0x1234, 1, 0x80, 50, 0xff};
+    cEep.vSetSegment(1, stSegment, false);
+    cEep.vSetSegmentCount(2, false);
+    JsonDocument doc;
+    cEep.vExport(doc.to<JsonObject>());
+    TEST_ASSERT_EQUAL_UINT16(cEep.u16LedCount, doc["ledCount"].as<uint16_t>());
+    TEST_ASSERT_EQUAL_STRING(cEep.acNtpServer1, doc["ntpServer1"].as<const char *>());
+    TEST_ASSERT_FALSE(doc["pwd"].is<const char *>());
+    TEST_ASSERT_FALSE(doc["chipId"].is<uint32_t>());
+    TEST_ASSERT_EQUAL(2, doc["segment"].size());
+    TEST_ASSERT_EQUAL_UINT16(0x1234, doc["segment"][1][3].as<uint16_t>());
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char **) {
+    UNITY_BEGIN();
+    RUN_TEST(test_factory_reset_single_commit);
+    RUN_TEST(test_burst_single_commit);
+    RUN_TEST(test_changes_postpone_commit);
+    RUN_TEST(test_flush);
+    RUN_TEST(test_layout_unchanged);
+    RUN_TEST(test_invalid_values_default);
+    RUN_TEST(test_invalid_segments_default);
+    RUN_TEST(test_set_clamps);
+    RUN_TEST(test_export);
+    return UNITY_END();
+}
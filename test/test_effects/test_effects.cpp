@@ -0,0 +1,161 @@
+// golden image test of the effects: every effect renders GoldenFrames frames
+// on a virtual clock, the frames are stacked to a PPM image (one row per frame)
+// and compared with test/golden/<effect>.ppm. A missing golden fails the test,
+// built with -D UPDATE_GOLDEN the goldens are written from the current output
+// instead, review them and commit them.
+#include <unity.h>
+#include <sys/stat.h>
+#include "MockStubs.h"
+#include "EffectHarness.h"
+
+#define GoldenLedCount    60
+#define GoldenMatrixWidth 10 // 10x6 matrix of the 2D effects
+#define GoldenFrames      32
+#define GoldenOutputDir   "test/output"
+#define GoldenDir         "test/golden"
+#define DimBrightness     8   // stripe brightness of the dither test, white is ~0.9 of the 8 bit LSB
+#define DimFrames         256
+
+//=============================================================================
+// frames (GRB pixel buffers) -> binary PPM in RGB order
+static std::vector<uint8_t> au8Ppm(const std::vector<std::vector<uint8_t>> &aFrames, uint16_t u16LedCount) {
+    char acHeader[32];
+    int iLen = sprintf(acHeader, "P6\n%d %d\n255\n", u16LedCount, (int)aFrames.size());
+    std::vector<uint8_t> au8Image(acHeader, acHeader + iLen);
+    for (const std::vector<uint8_t> &au8Frame : aFrames) {
+        for (uint16_t u16Led = 0; u16Led < u16LedCount; u16Led++) {
+            const uint8_t *pu8Grb = &au8Frame[u16Led * NeoGrbFeature::PixelSize];
+            au8Image.push_back(pu8Grb[1]);
+            au8Image.push_back(pu8Grb[0]);
+            au8Image.push_back(pu8Grb[2]);
+        }
+    }
+    return au8Image;
+}
+
+//=============================================================================
+static bool boReadFile(const std::string &sPath, std::vector<uint8_t> &au8Data) {
+    FILE *pFile = fopen(sPath.c_str(), "rb");
+    if (!pFile) return false;
+    uint8_t au8Chunk[1024];
+    size_t size;
+    au8Data.clear();
+    while ((size = fread(au8Chunk, 1, sizeof(au8Chunk), pFile)) > 0) au8Data.insert(au8Data.end(), au8Chunk, au8Chunk + size);
+    fclose(pFile);
+    return true;
+}
+
+//=============================================================================
+static void vWriteFile(const std::string &sPath, const std::vector<uint8_t> &au8Data) {
+    FILE *pFile = fopen(sPath.c_str(), "wb");
+    TEST_ASSERT_NOT_NULL_MESSAGE(pFile, sPath.c_str());
+    fwrite(au8Data.data(), 1, au8Data.size(), pFile);
+    fclose(pFile);
+}
+
+//=============================================================================
+static void vCheckEffect(tColorMode enMode) {
+    bool boMatrix = (enMode == nRainbow2D) || (enMode == nMovingPoint2D);
+    EffectHarness cHarness(GoldenLedCount, enMode, boMatrix ? GoldenMatrixWidth : 0);
+    std::vector<std::vector<uint8_t>> aFrames;
+    for (uint8_t u8Frame = 0; u8Frame < GoldenFrames; u8Frame++) {
+        aFrames.push_back(cHarness.au8Step());
+        TEST_ASSERT_EQUAL(GoldenLedCount * NeoGrbFeature::PixelSize, aFrames.back().size());
+    }
+    std::vector<uint8_t> au8Image = au8Ppm(aFrames, GoldenLedCount);
+
+    std::string sName = std::string("/") + astEffects[enMode].pcName + ".ppm";
+    mkdir(GoldenOutputDir, 0755);
+    vWriteFile(GoldenOutputDir + sName, au8Image); // for a visual diff with the golden
+
+#ifdef UPDATE_GOLDEN
+    vWriteFile(GoldenDir + sName, au8Image);
+    TEST_IGNORE_MESSAGE("golden written, review and commit it");
+#endif
+    std::vector<uint8_t> au8Golden;
+    TEST_ASSERT_TRUE_MESSAGE(boReadFile(GoldenDir + sName, au8Golden), "golden missing, build with -D UPDATE_GOLDEN");
+    TEST_ASSERT_EQUAL_MESSAGE(au8Golden.size(), au8Image.size(), "image size differs from the golden");
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(au8Golden.data(), au8Image.data(), au8Image.size(), "frames differ from the golden");
+}
+
+//=============================================================================
+// a static dim white below one 8 bit step: the dither keeps rendering and each
+// LED averages to the exact value, no LED is off all the time or brighter
+void test_dim_average() {
+    EffectHarness cHarness(GoldenLedCount, nMonochrome, 0);
+    cHarness.cEep.vSetSpeed(0, false);
+    cHarness.cEep.vSetSaturation(0, false);
+    cHarness.cEep.vSetBrightnessDay(DimBrightness, false);
+    cHarness.cEep.vSetBrightnessMin(0, false);
+    cHarness.cLedStripe.vSetColor(-1);
+
+    std::vector<uint32_t> au32Sum(GoldenLedCount * NeoGrbFeature::PixelSize, 0);
+    for (uint16_t u16Frame = 0; u16Frame < DimFrames; u16Frame++) {
+        const std::vector<uint8_t> &au8Frame = cHarness.au8Step();
+        for (size_t idx = 0; idx < au32Sum.size(); idx++) {
+            TEST_ASSERT_TRUE(au8Frame[idx] <= 1);
+            au32Sum[idx] += au8Frame[idx];
+        }
+    }
+    double dLightness = DimBrightness * 100.0 / 255.0; // CIE L*
+    double dExpected  = 255.0 * ((dLightness <= 8.0) ? (dLightness / 903.3) : pow((dLightness + 16.0) / 116.0, 3.0));
+    for (size_t idx = 0; idx < au32Sum.size(); idx++) {
+        TEST_ASSERT_INT_WITHIN(3, (int)lround(dExpected * DimFrames), au32Sum[idx]);
+    }
+}
+
+//=============================================================================
+// a LedCount, which doesn't fit, keeps the running stripe without changing the
+// stored LedCount, a later one, which fits, gets its own bus
+void test_led_count_fallback() {
+    EffectHarness cHarness(GoldenLedCount, nRandom, 0);
+    cHarness.au8Step();
+    cHarness.cEep.vSetLedCount(LedCountMax + 1, false);
+    cHarness.cLedStripe.vInit(&cHarness.cEep, &cHarness.cNtpTime);
+    TEST_ASSERT_EQUAL(GoldenLedCount * NeoGrbFeature::PixelSize, cHarness.au8Step().size());
+    TEST_ASSERT_EQUAL(LedCountMax + 1, cHarness.cEep.u16LedCount);
+
+    cHarness.cEep.vSetLedCount(LedCountMax, false);
+    cHarness.cLedStripe.vInit(&cHarness.cEep, &cHarness.cNtpTime);
+    cHarness.cLedStripe.vTurn(true, true);
+    TEST_ASSERT_EQUAL(LedCountMax * NeoGrbFeature::PixelSize, cHarness.au8Step().size());
+}
+
+//=============================================================================
+// a static scene above the dither limit is rendered, but not sent again
+void test_static_skipped() {
+    EffectHarness cHarness(GoldenLedCount, nRainbow, 0);
+    cHarness.cEep.vSetSpeed(0, false);
+    cHarness.cLedStripe.vSetColor(-1);
+    cHarness.au8Step();
+    cHarness.au8Step();
+    uint32_t u32FramesSent = cHarness.cLedStripe.u32GetFramesSent();
+    for (uint8_t u8Frame = 0; u8Frame < 10; u8Frame++) cHarness.au8Step();
+    TEST_ASSERT_EQUAL_UINT32(u32FramesSent, cHarness.cLedStripe.u32GetFramesSent());
+}
+
+void test_monochrome()      { vCheckEffect(nMonochrome); }
+void test_rainbow()         { vCheckEffect(nRainbow); }
+void test_random()          { vCheckEffect(nRandom); }
+void test_moving_point()    { vCheckEffect(nMovingPoint); }
+void test_rainbow_2d()      { vCheckEffect(nRainbow2D); }
+void test_moving_point_2d() { vCheckEffect(nMovingPoint2D); }
+void test_palette()         { vCheckEffect(nPalette); }
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char **) {
+    UNITY_BEGIN();
+    RUN_TEST(test_monochrome);
+    RUN_TEST(test_rainbow);
+    RUN_TEST(test_random);
+    RUN_TEST(test_moving_point);
+    RUN_TEST(test_rainbow_2d);
+    RUN_TEST(test_moving_point_2d);
+    RUN_TEST(test_palette);
+    RUN_TEST(test_dim_average);
+    RUN_TEST(test_led_count_fallback);
+    RUN_TEST(test_static_skipped);
+    return UNITY_END();
+}
@@ -0,0 +1,217 @@
+// append-only EEP log over a ring of flash sectors (FlashLog): replay, power
+// loss while writing and a simulated year of the EEP writes of a motion sensor
+// controlled stripe (erases per sector and replay time at the start).
+#include <unity.h>
+#include "MockStubs.h"
+#include "FlashLog.h"
+#include "Eep.h"
+
+#define LogFirstSector     EepLogSectors // the sectors below are used by Eep
+#define LogSectors         4
+#define LogImageSize       EepSize
+#define SimDays            365
+#define SimSwitchesPerDay  40     // motion sensor on/off with "restore switch status after PowerOn"
+#define SimFlashBytesPerUs 4      // assumed spi_flash_read throughput of the ESP8266 (40MHz DIO) [byte/us]
+#define SimFlashEndurance  100000 // erase cycles of the SPI flash
+
+static uint8_t au8Image[LogImageSize];
+static uint8_t au8Replayed[LogImageSize];
+
+//=============================================================================
+static void vClearLog() {
+    for (uint8_t u8Sector = LogFirstSector; u8Sector < LogFirstSector + LogSectors; u8Sector++) {
+        memset(&au8MockFlash[u8Sector * FlashLogSectorSize], 0xff, FlashLogSectorSize);
+        au32MockFlashErases[u8Sector] = 0;
+    }
+    lMockFlashWriteBudget = -1;
+    for (uint16_t u16Idx = 0; u16Idx < LogImageSize; u16Idx++) au8Image[u16Idx] = (uint8_t)(u16Idx * 7);
+}
+
+//=============================================================================
+// a new FlashLog (restart) replays the log into a cleared image
+static bool boReplay(FlashLog &cLog) {
+    memset(au8Replayed, 0, sizeof(au8Replayed));
+    return cLog.boInit(LogFirstSector, LogSectors, au8Replayed, LogImageSize);
+}
+
+//=============================================================================
+void test_crc() {
+    const char *pcCheck = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xcbf43926, FlashLog::u32Crc(0, (const uint8_t *)pcCheck, 9));
+    TEST_ASSERT_EQUAL_HEX32(0xcbf43926, FlashLog::u32Crc(FlashLog::u32Crc(0, (const uint8_t *)pcCheck, 4), (const uint8_t *)pcCheck + 4, 5));
+}
+
+void test_replay() {
+    vClearLog();
+    FlashLog cLog(0);
+    TEST_ASSERT_FALSE(cLog.boInit(LogFirstSector, LogSectors, au8Image, LogImageSize)); // empty flash
+    TEST_ASSERT_TRUE(cLog.boWrite());                                                  // first snapshot
+    au8Image[3] = 0x55;
+    au8Image[LogImageSize - 1] = 0xaa;
+    TEST_ASSERT_TRUE(cLog.boWrite());
+    TEST_ASSERT_EQUAL_UINT32(3, cLog.u32GetRecords());
+
+    FlashLog cRestart(0);
+    TEST_ASSERT_TRUE(boReplay(cRestart));
+    TEST_ASSERT_EQUAL_UINT16(3, cRestart.u16GetReplayedRecords());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(au8Image, au8Replayed, LogImageSize);
+}
+
+// changes closer than FlashLogMergeGap share a record, an unchanged image writes nothing
+void test_merge_records() {
+    vClearLog();
+    FlashLog cLog(0);
+    cLog.boInit(LogFirstSector, LogSectors, au8Image, LogImageSize);
+    cLog.boWrite();
+    uint32_t u32Records = cLog.u32GetRecords();
+    au8Image[100]++;
+    au8Image[100 + FlashLogMergeGap]++;
+    cLog.boWrite();
+    TEST_ASSERT_EQUAL_UINT32(u32Records + 1, cLog.u32GetRecords());
+    au8Image[200]++;
+    au8Image[201 + FlashLogMergeGap]++;
+    cLog.boWrite();
+    TEST_ASSERT_EQUAL_UINT32(u32Records + 3, cLog.u32GetRecords());
+    cLog.boWrite();
+    TEST_ASSERT_EQUAL_UINT32(u32Records + 3, cLog.u32GetRecords());
+}
+
+// the compactions move around the ring, each sector is erased equally often
+void test_wear_leveling() {
+    vClearLog();
+    FlashLog cLog(0);
+    cLog.boInit(LogFirstSector, LogSectors, au8Image, LogImageSize);
+    for (uint16_t u16Write = 0; u16Write < 5000; u16Write++) {
+        au8Image[(u16Write * 37) % LogImageSize]++;
+        TEST_ASSERT_TRUE(cLog.boWrite());
+    }
+    uint32_t u32Min = 0xffffffff;
+    uint32_t u32Max = 0;
+    uint32_t u32Sum = 0;
+    for (uint8_t u8Sector = LogFirstSector; u8Sector < LogFirstSector + LogSectors; u8Sector++) {
+        u32Min  = std::min(u32Min, au32MockFlashErases[u8Sector]);
+        u32Max  = std::max(u32Max, au32MockFlashErases[u8Sector]);
+        u32Sum += au32MockFlashErases[u8Sector];
+    }
+    TEST_ASSERT_TRUE(u32Min > 0);
+    TEST_ASSERT_TRUE(u32Max - u32Min <= 1);
+    TEST_ASSERT_EQUAL_UINT32(cLog.u32GetErases(), u32Sum);
+
+    FlashLog cRestart(0);
+    TEST_ASSERT_TRUE(boReplay(cRestart));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(au8Image, au8Replayed, LogImageSize);
+}
+
+// power loss within a record: the replay ends before it, the next write compacts
+void test_power_loss_record() {
+    vClearLog();
+    FlashLog cLog(0);
+    cLog.boInit(LogFirstSector, LogSectors, au8Image, LogImageSize);
+    cLog.boWrite();
+    au8Image[10]++;
+    cLog.boWrite();
+    uint8_t au8Before[LogImageSize];
+    memcpy(au8Before, au8Image, LogImageSize);
+    au8Image[20]++;
+    lMockFlashWriteBudget = 6; // header and half of the data
+    TEST_ASSERT_FALSE(cLog.boWrite());
+    lMockFlashWriteBudget = -1;
+
+    FlashLog cRestart(0);
+    TEST_ASSERT_TRUE(boReplay(cRestart));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(au8Before, au8Replayed, LogImageSize);
+    uint32_t u32Erases = cRestart.u32GetErases();
+    au8Replayed[30]++;
+    TEST_ASSERT_TRUE(cRestart.boWrite());
+    TEST_ASSERT_EQUAL_UINT32(u32Erases + 1, cRestart.u32GetErases());
+
+    FlashLog cRestart2(0);
+    memcpy(au8Before, au8Replayed, LogImageSize);
+    TEST_ASSERT_TRUE(boReplay(cRestart2));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(au8Before, au8Replayed, LogImageSize);
+}
+
+// power loss within a compaction: the replay uses the last complete sector
+void test_power_loss_compaction() {
+    vClearLog();
+    FlashLog cLog(0);
+    cLog.boInit(LogFirstSector, LogSectors, au8Image, LogImageSize);
+    cLog.boWrite();
+    uint32_t u32Erases = cLog.u32GetErases();
+    uint8_t au8Before[LogImageSize];
+    while (cLog.u32GetErases() == u32Erases) {
+        memcpy(au8Before, au8Image, LogImageSize);
+        au8Image[50]++;
+        lMockFlashWriteBudget = 200; // enough for a record, not for a snapshot
+        cLog.boWrite();
+    }
+    lMockFlashWriteBudget = -1;
+
+    FlashLog cRestart(0);
+    TEST_ASSERT_TRUE(boReplay(cRestart));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(au8Before, au8Replayed, LogImageSize);
+}
+
+//=============================================================================
+// one year of the EEP writes through Eep (write-behind) with the switch status
+// of a motion sensor, a few brightness and color changes
+void test_year_simulation() {
+    for (uint8_t u8Sector = 0; u8Sector < EepLogSectors; u8Sector++) au32MockFlashErases[u8Sector] = 0;
+    Eep cEep(0);
+    NtpTime cNtpTime(0);
+    llMockMicros = 1000000;
+    cEep.vInit(&cNtpTime);
+    cEep.vSetPowerOnRestoreSwitch(1, false);
+    uint32_t u32Commits = cEep.u32GetCommits();
+    for (uint16_t u16Day = 0; u16Day < SimDays; u16Day++) {
+        for (uint8_t u8Switch = 0; u8Switch < SimSwitchesPerDay; u8Switch++) {
+            cEep.vSetSwitchStatus(!cEep.u8SwitchStatus, false);
+            if (!(u8Switch % 20)) cEep.vSetBrightnessNight(cEep.u8BrightnessNight + 1, false);
+            if (!(u8Switch % 40) && !(u16Day % 7)) cEep.vSetHue(cEep.u16Hue + 1000, false);
+            llMockMicros += 86400000000LL / SimSwitchesPerDay;
+            cEep.vLoop();
+        }
+    }
+    uint32_t u32YearCommits = cEep.u32GetCommits() - u32Commits;
+    uint32_t u32MaxErases   = 0;
+    for (uint8_t u8Sector = 0; u8Sector < EepLogSectors; u8Sector++) {
+        u32MaxErases = std::max(u32MaxErases, au32MockFlashErases[u8Sector]);
+    }
+
+    char buffer[160];
+    snprintf(buffer, sizeof(buffer), "year: %lu commits, EEPROM sector: %lu erases, log: %lu erases in %d sectors (max. %lu/sector)",
+        (unsigned long)u32YearCommits, (unsigned long)u32YearCommits, (unsigned long)cEep.u32GetErases(), EepLogSectors, (unsigned long)u32MaxErases);
+    TEST_MESSAGE(buffer);
+    snprintf(buffer, sizeof(buffer), "flash life (%d cycles): EEPROM sector %.1f years, log %.0f years",
+        SimFlashEndurance, (double)SimFlashEndurance / u32YearCommits, (double)SimFlashEndurance / u32MaxErases);
+    TEST_MESSAGE(buffer);
+    TEST_ASSERT_TRUE(u32YearCommits >= SimDays * SimSwitchesPerDay);
+    TEST_ASSERT_TRUE(u32MaxErases * 100 < u32YearCommits);
+
+    // start after the year, the worst case is a full sector
+    FlashLog cBoot(0);
+    uint8_t au8BootImage[EepSize];
+    TEST_ASSERT_TRUE(cBoot.boInit(0, EepLogSectors, au8BootImage, EepSize));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(EEPROM.au8Data, au8BootImage, EepSize);
+    uint32_t u32WorstBytes = EepLogSectors * FlashLogHeaderSize + FlashLogSectorSize;
+    snprintf(buffer, sizeof(buffer), "start: %d records, %lu byte read (~%lu us), worst case %lu byte (~%lu us), EEPROM sector: %d byte (~%d us)",
+        cBoot.u16GetReplayedRecords(), (unsigned long)cBoot.u32GetReplayedBytes(), (unsigned long)(cBoot.u32GetReplayedBytes() / SimFlashBytesPerUs),
+        (unsigned long)u32WorstBytes, (unsigned long)(u32WorstBytes / SimFlashBytesPerUs), EepSize, EepSize / SimFlashBytesPerUs);
+    TEST_MESSAGE(buffer);
+    TEST_ASSERT_TRUE(cBoot.u32GetReplayedBytes() <= u32WorstBytes);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char **) {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc);
+    RUN_TEST(test_replay);
+    RUN_TEST(test_merge_records);
+    RUN_TEST(test_wear_leveling);
+    RUN_TEST(test_power_loss_record);
+    RUN_TEST(test_power_loss_compaction);
+    RUN_TEST(test_year_simulation);
+    return UNITY_END();
+}
@@ -0,0 +1,54 @@
+// LedCount changes against the counting allocator of the mock heap (MockStubs.h)
+#include <unity.h>
+#include "MockStubs.h"
+#include "EffectHarness.h"
+
+#define ReconfigCount  100 // LedCount changes
+#define ReconfigSmall  300
+#define ReconfigLarge  600
+#define BusAllocs      2   // pixel and I2S buffer of the bus
+
+void setUp() {}
+void tearDown() { vMockHeapStop(); }
+
+//=============================================================================
+static void vSetLedCount(EffectHarness &cHarness, uint16_t u16LedCount) {
+    cHarness.cEep.vSetLedCount(u16LedCount, false);
+    cHarness.cLedStripe.vInit(&cHarness.cEep, &cHarness.cNtpTime);
+    TEST_ASSERT_EQUAL(u16LedCount * NeoGrbFeature::PixelSize, cHarness.au8Step().size());
+}
+
+//=============================================================================
+// alternating LedCounts only recreate the bus: the heap in use and the largest
+// free block are the same after each change back, the arena isn't allocated again
+void test_reconfig_heap() {
+    vMockHeapStart();
+    EffectHarness cHarness(ReconfigSmall, nRandom, 0);
+    cHarness.au8Step();
+    // the first change grows the sent frame of the mock to the large LedCount
+    vSetLedCount(cHarness, ReconfigLarge);
+    vSetLedCount(cHarness, ReconfigSmall);
+    uint32_t u32Free     = ESP.getFreeHeap();
+    uint32_t u32MaxBlock = ESP.getMaxFreeBlockSize();
+
+    for (uint8_t u8Reconfig = 0; u8Reconfig < ReconfigCount / 2; u8Reconfig++) {
+        uint32_t u32Allocs = u32MockAllocs;
+        vSetLedCount(cHarness, ReconfigLarge);
+        vSetLedCount(cHarness, ReconfigSmall);
+        TEST_ASSERT_EQUAL_UINT32(2 * BusAllocs, u32MockAllocs - u32Allocs);
+        TEST_ASSERT_EQUAL_UINT32(u32Free, ESP.getFreeHeap());
+        TEST_ASSERT_EQUAL_UINT32(u32MaxBlock, ESP.getMaxFreeBlockSize());
+    }
+    // reported at the end, the first output allocates the buffer of stdout
+    char buffer[120];
+    snprintf(buffer, sizeof(buffer), "FreeHeap:%lu MaxFreeBlock:%lu Fragmentation:%d%%",
+        (unsigned long)u32Free, (unsigned long)u32MaxBlock, ESP.getHeapFragmentation());
+    TEST_MESSAGE(buffer);
+}
+
+//=============================================================================
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reconfig_heap);
+    return UNITY_END();
+}
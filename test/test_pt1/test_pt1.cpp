@@ -0,0 +1,89 @@
+// PT1 against the analytic step response y(t) = y0 + (x - y0) * (1 - exp(-t/tau))
+#include <unity.h>
+#include "MockStubs.h"
+#include "PT1.h"
+
+#define Pt1Tau 150 // [ms]
+
+//=============================================================================
+static double dAnalytic(double dStart, double dTarget, double dTimeMs, double dTau) {
+    return dStart + (dTarget - dStart) * (1.0 - exp(-dTimeMs / dTau));
+}
+
+//=============================================================================
+// step response with the given call intervals, each output within +/-1 of the curve
+static void vCheckStep(int16_t i16Start, int16_t i16Target, const uint16_t *pu16Delta, uint8_t u8Deltas, uint16_t u16Calls) {
+    PT1 cPt1(Pt1Tau);
+    llMockMicros = 1000000;
+    cPt1.vInitDampVal(i16Start);
+    unsigned long ulTime = 0; // [ms]
+    for (uint16_t u16Call = 0; u16Call < u16Calls; u16Call++) {
+        uint16_t u16Delta = pu16Delta[u16Call % u8Deltas];
+        ulTime       += u16Delta;
+        llMockMicros += u16Delta * 1000LL;
+        int16_t i16Damped = cPt1.i16GetDampedVal(i16Target);
+        TEST_ASSERT_INT_WITHIN(1, (int)lround(dAnalytic(i16Start, i16Target, ulTime, Pt1Tau)), i16Damped);
+    }
+}
+
+//=============================================================================
+void test_exp_table() {
+    for (uint32_t u32Ratio = 0; u32Ratio < ((uint32_t)PT1ExpMax << 16) + 1000; u32Ratio += 97) {
+        TEST_ASSERT_INT_WITHIN(2, (int)lround(65536.0 * exp(-(double)u32Ratio / 65536.0)), PT1::u32ExpNeg(u32Ratio));
+    }
+}
+
+void test_step_up_20ms() {
+    const uint16_t au16Delta[] = {20};
+    vCheckStep(0, 255, au16Delta, 1, 100);
+}
+
+void test_step_down_1ms() {
+    const uint16_t au16Delta[] = {1};
+    vCheckStep(255, 0, au16Delta, 1, 1500);
+}
+
+// the curve must not depend on the loop timing
+void test_step_irregular() {
+    const uint16_t au16Delta[] = {3, 41, 7, 1, 19, 88, 2, 33};
+    vCheckStep(24, 255, au16Delta, sizeof(au16Delta) / sizeof(au16Delta[0]), 60);
+}
+
+// a late call catches up the whole time
+void test_late_call() {
+    const uint16_t au16Delta[] = {10, 400, 10, 10};
+    vCheckStep(255, 24, au16Delta, sizeof(au16Delta) / sizeof(au16Delta[0]), 8);
+}
+
+void test_no_time_no_step() {
+    PT1 cPt1(Pt1Tau);
+    llMockMicros = 1000000;
+    cPt1.vInitDampVal(0);
+    TEST_ASSERT_EQUAL(0, cPt1.i16GetDampedVal(255));
+    llMockMicros += 1000000;
+    TEST_ASSERT_EQUAL(255, cPt1.i16GetDampedVal(255)); // far beyond 12 tau
+}
+
+void test_no_damping() {
+    PT1 cPt1(0);
+    cPt1.vInitDampVal(0);
+    TEST_ASSERT_EQUAL(200, cPt1.i16GetDampedVal(200));
+    cPt1.vSetTau(Pt1Tau);
+    llMockMicros += 20000;
+    TEST_ASSERT_INT_WITHIN(1, (int)lround(dAnalytic(200, 0, 20, Pt1Tau)), cPt1.i16GetDampedVal(0));
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char **) {
+    UNITY_BEGIN();
+    RUN_TEST(test_exp_table);
+    RUN_TEST(test_step_up_20ms);
+    RUN_TEST(test_step_down_1ms);
+    RUN_TEST(test_step_irregular);
+    RUN_TEST(test_late_call);
+    RUN_TEST(test_no_time_no_step);
+    RUN_TEST(test_no_damping);
+    return UNITY_END();
+}